@@ -0,0 +1,661 @@
+/**
+ * @file bench_tag_encoding.cpp
+ *
+ * Microbenchmarks for "tag_encode.h": `tag_encode()`, `tag_decode()` and
+ * `tag_try_decode()` at 1-, 4-, 8- and 15-character tags, decoding of
+ * valid/invalid mixes and of mixed-case or '0'/'1'-aliased input, the
+ * encoding kernels (per-character loop and three-character group table),
+ * `tag_counter`, and every batch encoder and decoder kernel the CPU
+ * supports.  Where Linux perf events are available each benchmark also
+ * reports `cycles/op` (otherwise `tsc/op` on x86).
+ *
+ * Build with Google Benchmark, and write JSON for regression tracking:
+ *     g++ -std=c++17 -O2 -o bench_tag_encoding bench_tag_encoding.cpp -lbenchmark -lpthread
+ *     ./bench_tag_encoding --benchmark_out=bench.json --benchmark_out_format=json
+ * 
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include<vector>
+#include<string>
+#include<random>
+#include<limits>
+#include<cstring>
+#include<cctype>
+#include<unordered_map>
+
+#include<benchmark/benchmark.h>
+
+#if defined(__linux__)
+#include<linux/perf_event.h>
+#include<sys/syscall.h>
+#include<unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include<x86intrin.h>
+#endif
+
+#include "tag_encode.h"
+
+/**
+ * @brief  serial numbers whose tags are all `length` characters long
+ */
+static std::vector<long int> serials_of_length(int length){
+    const auto& limit = tag_encode_detail::LENGTHS.limit;                          // limit[L-1]: first serial longer than L
+    long int    lower = (length == 1) ? 0 : limit[length - 2];
+    long int    upper = (length == TAG_MAX_LENGTH) ? std::numeric_limits<long int>::max() : limit[length - 1] - 1;
+    std::mt19937_64                         rng(length);
+    std::uniform_int_distribution<long int> pick(lower, upper);
+    std::vector<long int>                   serials(4096);
+    for(long int& serial : serials){
+        serial = pick(rng);
+    }
+    return serials;
+}
+
+/**
+ * @brief  tags of `length` characters; `invalid_percent` of them are made invalid and
+ *         `aliased` ones are randomly upper-cased with 'o'/'l' typed as '0'/'1'
+ */
+static std::vector<std::string> tags_of_length(int length, int invalid_percent = 0, bool aliased = false){
+    std::vector<long int>           serials = serials_of_length(length);
+    std::vector<std::string>        tags;
+    std::mt19937_64                 rng(length * 100 + invalid_percent);
+    std::uniform_int_distribution<> percent(0, 99), coin(0, 1);
+    std::uniform_int_distribution<> position(0, length - 1);
+    for(long int serial : serials){
+        std::string tag = tag_encode(serial);
+        if(aliased){
+            for(char& c : tag){
+                c = (c == 'o') ? '0' : (c == 'l') ? '1' : coin(rng) ? std::toupper(c) : c;
+            }
+        }
+        if(percent(rng) < invalid_percent){
+            if(length > 1 && coin(rng)){
+                tag[0] = tag_encode_detail::digit_char(0, BASE_SELECT[(length - 1) % 3]);    // leading zero digit
+            }else{
+                tag[position(rng)] = '!';                                           // character outside the alphabet
+            }
+        }
+        tags.push_back(tag);
+    }
+    return tags;
+}
+
+/**
+ * @brief  reports CPU cycles per item from a Linux perf event, or TSC ticks where perf is unavailable
+ *
+ * Construct it just before the benchmark loop and call `report()` after it.
+ */
+class cycle_meter{
+public:
+    cycle_meter(){
+        start = read();
+    }
+
+    void report(benchmark::State& state, std::int64_t items){
+        std::uint64_t stop = read();
+        if(source() != nullptr && items > 0){
+            state.counters[source()] = benchmark::Counter(static_cast<double>(stop - start) / items);
+        }
+    }
+
+private:
+    static int perf_fd(){
+#if defined(__linux__)
+        static int fd = []{
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size           = sizeof(attr);
+            attr.type           = PERF_TYPE_HARDWARE;
+            attr.config         = PERF_COUNT_HW_CPU_CYCLES;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }();
+        return fd;
+#else
+        return -1;
+#endif
+    }
+
+    static const char* source(){
+        if(perf_fd() >= 0){
+            return "cycles/op";
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        return "tsc/op";
+#else
+        return nullptr;
+#endif
+    }
+
+    static std::uint64_t read(){
+        std::uint64_t count = 0;
+#if defined(__linux__)
+        if(perf_fd() >= 0 && ::read(perf_fd(), &count, sizeof(count)) == sizeof(count)){
+            return count;
+        }
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+        count = __rdtsc();
+#endif
+        return count;
+    }
+
+    std::uint64_t start;
+};
+
+static void BM_tag_encode(benchmark::State& state){
+    std::vector<long int> serials = serials_of_length(state.range(0));
+    std::size_t           i = 0;
+    cycle_meter           cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(tag_encode(serials[i++ & 4095]));
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_tag_encode_buffer(benchmark::State& state){
+    std::vector<long int> serials = serials_of_length(state.range(0));
+    char                  tag[TAG_MAX_LENGTH];
+    std::size_t           i = 0;
+    cycle_meter           cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(tag_encode(serials[i++ & 4095], tag, TAG_MAX_LENGTH));
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_tag_encode)->Arg(1)->Arg(4)->Arg(8)->Arg(15);
+BENCHMARK(BM_tag_encode_buffer)->Arg(1)->Arg(4)->Arg(8)->Arg(15);
+
+/**
+ * @brief  `tag_scrambler::encode()` (buffer form) of consecutive serials; arg is the domain width in bits
+ */
+static void BM_tag_scrambler_encode(benchmark::State& state){
+    tag_scrambler scrambler(0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL, state.range(0));
+    char          tag[TAG_MAX_LENGTH];
+    long int      serial = 0, mask = static_cast<long int>((std::uint64_t(1) << state.range(0)) - 1);
+    cycle_meter   cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(scrambler.encode(serial++ & mask, tag, TAG_MAX_LENGTH));
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief  `tag_scrambler::try_decode()` of scrambled tags; arg is the domain width in bits
+ */
+static void BM_tag_scrambler_decode(benchmark::State& state){
+    tag_scrambler            scrambler(0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL, state.range(0));
+    std::vector<std::string> tags;
+    for(long int serial = 0; serial < 4096; serial++){
+        tags.push_back(scrambler.encode(serial));
+    }
+    long int    serial = 0;
+    std::size_t i      = 0;
+    cycle_meter cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(scrambler.try_decode(tags[i++ & 4095], serial));
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_tag_scrambler_encode)->ArgName("bits")->Arg(32)->Arg(63);
+BENCHMARK(BM_tag_scrambler_decode)->ArgName("bits")->Arg(32)->Arg(63);
+
+/**
+ * @brief  `tag_encode_checked()` into a buffer; compare with `BM_tag_encode_buffer`
+ */
+static void BM_tag_encode_checked(benchmark::State& state){
+    std::vector<long int> serials = serials_of_length(state.range(0));
+    char                  tag[TAG_MAX_LENGTH_CHECKED];
+    std::size_t           i = 0;
+    cycle_meter           cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(tag_encode_checked(serials[i++ & 4095], tag, TAG_MAX_LENGTH_CHECKED));
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief  `tag_try_decode_checked()` of checked tags, with a share of single-character typos
+ */
+static void BM_tag_try_decode_checked(benchmark::State& state){
+    std::vector<long int>    serials = serials_of_length(state.range(0));
+    std::vector<std::string> tags;
+    std::mt19937_64          rng(state.range(1));
+    for(long int serial : serials){
+        std::string tag = tag_encode_checked(serial);
+        if(static_cast<long int>(rng() % 100) < state.range(1)){
+            char& c = tag[rng() % tag.size()];
+            c = c == 'z' ? 'y' : 'z';
+        }
+        tags.push_back(tag);
+    }
+    long int    serial = 0;
+    std::size_t i      = 0;
+    cycle_meter cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(tag_try_decode_checked(tags[i++ & 4095], serial));
+        benchmark::DoNotOptimize(serial);
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_tag_encode_checked)->ArgName("length")->Arg(4)->Arg(8)->Arg(15);
+BENCHMARK(BM_tag_try_decode_checked)->ArgNames({"length", "typo%"})->Args({4, 0})->Args({8, 0})->Args({15, 0})->Args({8, 50});
+
+/**
+ * @brief  a decimal `tag_codec`, for comparing a variant schedule with the default one
+ */
+struct decimal_alphabet{
+    static constexpr std::string_view symbols = "0123456789";
+    static constexpr std::string_view aliases = "";
+};
+
+using decimal_codec = tag_codec<decimal_alphabet, tag_radix<0, 10>>;
+
+/**
+ * @brief  `Codec::encode()` into a buffer; compare `tag_default_codec` with `BM_tag_encode_buffer`
+ */
+template<typename Codec>
+static void BM_codec_encode(benchmark::State& state){
+    std::vector<long int> serials = serials_of_length(state.range(0));
+    char                  tag[Codec::max_length];
+    std::size_t           i = 0;
+    cycle_meter           cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(Codec::encode(serials[i++ & 4095], tag, Codec::max_length));
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief  `Codec::try_decode()` of the codec's own tags
+ */
+template<typename Codec>
+static void BM_codec_try_decode(benchmark::State& state){
+    std::vector<std::string> tags;
+    for(long int serial : serials_of_length(state.range(0))){
+        tags.push_back(Codec::encode(serial));
+    }
+    long int    serial = 0;
+    std::size_t i      = 0;
+    cycle_meter cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(Codec::try_decode(tags[i++ & 4095], serial));
+        benchmark::DoNotOptimize(serial);
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_codec_encode, tag_default_codec)->Arg(4)->Arg(8)->Arg(15);
+BENCHMARK_TEMPLATE(BM_codec_encode, decimal_codec)->Arg(4)->Arg(8)->Arg(15);
+BENCHMARK_TEMPLATE(BM_codec_try_decode, tag_default_codec)->Arg(4)->Arg(8)->Arg(15);
+BENCHMARK_TEMPLATE(BM_codec_try_decode, decimal_codec)->Arg(4)->Arg(8)->Arg(15);
+
+#if defined(__SIZEOF_INT128__)
+/**
+ * @brief  `tag_encode_u128()`; arg is the bit width of the serials (above 64 they are split into limbs)
+ */
+static void BM_tag_encode_u128(benchmark::State& state){
+    int                        width = state.range(0);
+    std::mt19937_64            rng(width);
+    std::vector<tag_uint128_t> serials(4096);
+    for(tag_uint128_t& serial : serials){
+        tag_uint128_t bits = (static_cast<tag_uint128_t>(rng()) << 64) | rng();
+        serial = width < 128 ? (bits >> (128 - width)) | (tag_uint128_t(1) << (width - 1)) : bits;
+    }
+    char        tag[TAG_MAX_LENGTH_U128];
+    std::size_t i = 0;
+    cycle_meter cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(tag_encode_u128(serials[i++ & 4095], tag, TAG_MAX_LENGTH_U128));
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_tag_encode_u128)->ArgName("bits")->Arg(32)->Arg(64)->Arg(96)->Arg(128);
+#endif
+
+/**
+ * @brief  `tag_decode()`; args are the tag length and the percentage of invalid tags (each one throws)
+ */
+static void BM_tag_decode(benchmark::State& state){
+    std::vector<std::string> tags = tags_of_length(state.range(0), state.range(1));
+    std::size_t              i = 0;
+    cycle_meter              cycles;
+    for(auto _ : state){
+        try{
+            benchmark::DoNotOptimize(tag_decode(tags[i++ & 4095]));
+        }catch(std::invalid_argument&){}
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief  `tag_try_decode()`; args are the tag length, the percentage of invalid tags and whether input is aliased
+ */
+static void BM_tag_try_decode(benchmark::State& state){
+    std::vector<std::string> tags = tags_of_length(state.range(0), state.range(1), state.range(2));
+    std::size_t              i = 0;
+    long int                 serial = 0;
+    cycle_meter              cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(tag_try_decode(tags[i++ & 4095], serial));
+        benchmark::DoNotOptimize(serial);
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief  `tag_is_plausible()`, the pre-filter to compare with `BM_tag_try_decode`
+ */
+static void BM_tag_is_plausible(benchmark::State& state){
+    std::vector<std::string> tags = tags_of_length(state.range(0), state.range(1), 0);
+    std::size_t              i = 0;
+    cycle_meter              cycles;
+    for(auto _ : state){
+        const std::string& tag = tags[i++ & 4095];
+        benchmark::DoNotOptimize(tag_is_plausible(tag.data(), tag.size()));
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_tag_decode)->ArgNames({"length", "invalid%"})
+    ->Args({1, 0})->Args({4, 0})->Args({8, 0})->Args({15, 0})->Args({8, 10})->Args({8, 50});
+BENCHMARK(BM_tag_try_decode)->ArgNames({"length", "invalid%", "aliased"})
+    ->Args({1, 0, 0})->Args({4, 0, 0})->Args({8, 0, 0})->Args({15, 0, 0})
+    ->Args({8, 10, 0})->Args({8, 50, 0})->Args({8, 0, 1})->Args({15, 0, 1});
+BENCHMARK(BM_tag_is_plausible)->ArgNames({"length", "invalid%"})
+    ->Args({1, 0})->Args({4, 0})->Args({8, 0})->Args({15, 0})->Args({8, 50});
+
+template<void (*Kernel)(long int, char*)>
+static void BM_encode_kernel(benchmark::State& state){
+    std::vector<long int> serials = serials_of_length(state.range(0));
+    char                  tag[TAG_MAX_LENGTH];
+    std::size_t           i = 0;
+    cycle_meter           cycles;
+    for(auto _ : state){
+        Kernel(serials[i++ & 4095], tag + TAG_MAX_LENGTH);
+        benchmark::DoNotOptimize(tag);
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_encode_kernel, tag_encode_detail::encode_digits)->Arg(1)->Arg(4)->Arg(8)->Arg(12)->Arg(15);
+BENCHMARK_TEMPLATE(BM_encode_kernel, tag_encode_detail::encode_groups)->Arg(1)->Arg(4)->Arg(8)->Arg(12)->Arg(15);
+
+/**
+ * @brief  consecutive serials from the first `length`-character one: re-encoded, then stepped by `tag_counter`
+ */
+static void BM_encode_consecutive(benchmark::State& state){
+    long int    serial = tag_encode_detail::LENGTHS.limit[state.range(0) - 2];
+    char        tag[TAG_MAX_LENGTH];
+    cycle_meter cycles;
+    for(auto _ : state){
+        tag_encode(serial++, tag, TAG_MAX_LENGTH);
+        benchmark::DoNotOptimize(tag);
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_tag_counter(benchmark::State& state){
+    tag_counter counter(tag_encode_detail::LENGTHS.limit[state.range(0) - 2]);
+    cycle_meter cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize((++counter).tag().data());
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_encode_consecutive)->Arg(8)->Arg(15);
+BENCHMARK(BM_tag_counter)->Arg(8)->Arg(15);
+
+/**
+ * @brief  a result set of 4096 tags as one `std::string` per row (the allocation baseline for `BM_tag_column`)
+ */
+static void BM_encode_rows(benchmark::State& state){
+    std::vector<long int>    serials = serials_of_length(state.range(0));
+    std::vector<std::string> rows(serials.size());
+    cycle_meter              cycles;
+    for(auto _ : state){
+        for(std::size_t i = 0; i < serials.size(); i++){
+            rows[i] = tag_encode(serials[i]);
+        }
+        benchmark::DoNotOptimize(rows.data());
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations() * serials.size());
+    state.SetItemsProcessed(state.iterations() * serials.size());
+}
+
+/**
+ * @brief  the same result set encoded into a reused `tag_column`
+ */
+static void BM_tag_column(benchmark::State& state){
+    std::vector<long int>     serials = serials_of_length(state.range(0));
+    std::vector<std::int64_t> in(serials.begin(), serials.end());
+    tag_column                column;
+    cycle_meter               cycles;
+    for(auto _ : state){
+        column.assign(in.data(), in.size());
+        benchmark::DoNotOptimize(column.data());
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations() * in.size());
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+BENCHMARK(BM_encode_rows)->Arg(4)->Arg(8)->Arg(15);
+BENCHMARK(BM_tag_column)->Arg(4)->Arg(8)->Arg(15);
+
+template<void (*Kernel)(const std::int64_t*, std::size_t, char*, std::uint8_t*), tag_encode_detail::cpu_level Level>
+static void BM_encode_batch(benchmark::State& state){
+    if(tag_encode_detail::cpu() < Level){
+        state.SkipWithError("kernel not supported by this CPU");
+        return;
+    }
+    std::vector<long int>     serials = serials_of_length(state.range(0));
+    std::vector<std::int64_t> in(serials.begin(), serials.end());
+    std::vector<char>         out(in.size() * TAG_BATCH_STRIDE);
+    std::vector<std::uint8_t> lens(in.size());
+    cycle_meter               cycles;
+    for(auto _ : state){
+        Kernel(in.data(), in.size(), out.data(), lens.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations() * in.size());
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+BENCHMARK_TEMPLATE(BM_encode_batch, tag_encode_detail::encode_batch_scalar, tag_encode_detail::cpu_level::scalar)->Arg(1)->Arg(4)->Arg(8)->Arg(15);
+#if TAG_ENCODE_AVX2
+BENCHMARK_TEMPLATE(BM_encode_batch, tag_encode_detail::encode_batch_avx2, tag_encode_detail::cpu_level::avx2)->Arg(1)->Arg(4)->Arg(8)->Arg(15);
+#endif
+#if TAG_ENCODE_AVX512
+BENCHMARK_TEMPLATE(BM_encode_batch, tag_encode_detail::encode_batch_avx512, tag_encode_detail::cpu_level::avx512)->Arg(1)->Arg(4)->Arg(8)->Arg(15);
+#endif
+
+template<void (*Kernel)(const char*, std::size_t, std::int64_t*, std::uint8_t*), tag_encode_detail::cpu_level Level>
+static void BM_decode_batch(benchmark::State& state){
+    if(tag_encode_detail::cpu() < Level){
+        state.SkipWithError("kernel not supported by this CPU");
+        return;
+    }
+    std::vector<long int>     serials = serials_of_length(state.range(0));
+    std::vector<std::int64_t> in(serials.begin(), serials.end());
+    std::vector<char>         slots(in.size() * TAG_BATCH_STRIDE);
+    std::vector<std::uint8_t> lens(in.size()), valid((in.size() + 7) / 8);
+    tag_encode_batch(in.data(), in.size(), slots.data(), lens.data());
+    cycle_meter               cycles;
+    for(auto _ : state){
+        Kernel(slots.data(), in.size(), in.data(), valid.data());
+        benchmark::DoNotOptimize(in.data());
+        benchmark::ClobberMemory();
+    }
+    cycles.report(state, state.iterations() * in.size());
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+BENCHMARK_TEMPLATE(BM_decode_batch, tag_encode_detail::decode_batch_scalar, tag_encode_detail::cpu_level::scalar)->Arg(1)->Arg(4)->Arg(8)->Arg(15);
+#if TAG_ENCODE_SSSE3
+BENCHMARK_TEMPLATE(BM_decode_batch, tag_encode_detail::decode_batch_ssse3, tag_encode_detail::cpu_level::ssse3)->Arg(1)->Arg(4)->Arg(8)->Arg(15);
+#endif
+
+/*
+ * One MiB of access-log-like text in which one token in four is a tag.
+ */
+static std::string log_text(){
+    std::mt19937_64 rng(42);
+    std::string     text;
+    while(text.size() < (1 << 20)){
+        text += "127.0.0.1 - - [10/Oct/2013:13:55:36] \"GET /item/";
+        text += tag_encode(static_cast<long int>(rng() >> (20 + rng() % 30)));
+        text += "?ref=mail HTTP/1.1\" 200 2326 \"Mozilla/5.0\"\n";
+    }
+    return text;
+}
+
+/**
+ * @brief  `tag_scan()` over log lines, reported in bytes per second
+ */
+static void BM_tag_scan(benchmark::State& state){
+    std::string text  = log_text();
+    std::size_t found = 0;
+    for(auto _ : state){
+        found += tag_scan(text.data(), text.size(), [](const tag_match& match){ benchmark::DoNotOptimize(match.serial); });
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.counters["tags"] = static_cast<double>(found) / state.iterations();
+}
+
+/**
+ * @brief  the byte-at-a-time baseline for `BM_tag_scan`: split on non-alphanumerics, decode every run
+ */
+static void BM_scan_bytewise(benchmark::State& state){
+    std::string text  = log_text();
+    std::size_t found = 0;
+    for(auto _ : state){
+        for(std::size_t i = 0; i < text.size();){
+            std::size_t j = i;
+            while(j < text.size() && std::isalnum(static_cast<unsigned char>(text[j]))){
+                j++;
+            }
+            long int serial = 0;
+            if(j - i >= 4 && tag_try_decode(std::string_view(text).substr(i, j - i), serial) == tag_decode_status::ok){
+                benchmark::DoNotOptimize(serial);
+                found++;
+            }
+            i = std::max(j, i + 1);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.counters["tags"] = static_cast<double>(found) / state.iterations();
+}
+
+BENCHMARK(BM_tag_scan);
+BENCHMARK(BM_scan_bytewise);
+
+/**
+ * @brief  `tag_range_cover()` on random ranges of up to 2^`range(0)` serials
+ */
+static void BM_tag_range_cover(benchmark::State& state){
+    std::mt19937_64       random(42);
+    std::vector<long int> bounds;
+    for(int i = 0; i < 4096; i++){
+        bounds.push_back(static_cast<long int>(random() >> 2));
+    }
+    std::size_t i = 0, pieces = 0;
+    for(auto _ : state){
+        long int lo = bounds[i++ & 4095], hi = lo + (bounds[i & 4095] >> (62 - state.range(0)));
+        pieces += tag_range_cover(lo, hi).size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["pieces"] = static_cast<double>(pieces) / state.iterations();
+}
+
+BENCHMARK(BM_tag_range_cover)->Arg(8)->Arg(24)->Arg(40);
+
+/**
+ * @brief  hash-map lookup keyed by `Key`: `std::string` tags against `tag_value`, which hashes to the serial
+ */
+template<typename Key>
+static void BM_cache_lookup(benchmark::State& state){
+    std::vector<long int>                 serials = serials_of_length(state.range(0));
+    std::vector<Key>                      keys;
+    std::unordered_map<Key, std::int64_t> cache;
+    for(long int serial : serials){
+        keys.emplace_back(tag_encode(serial));
+        cache.emplace(keys.back(), serial);
+    }
+    std::size_t i = 0;
+    cycle_meter cycles;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(cache.find(keys[(i++ * 2654435761u) & 4095]));     // scattered, so the bucket is not in cache every time
+    }
+    cycles.report(state, state.iterations());
+    state.SetItemsProcessed(state.iterations());
+    state.counters["key_bytes"] = sizeof(Key);
+}
+
+BENCHMARK_TEMPLATE(BM_cache_lookup, std::string)->Arg(8)->Arg(15);
+BENCHMARK_TEMPLATE(BM_cache_lookup, tag_value)->Arg(8)->Arg(15);
+
+int main(int argc, char** argv){
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv)){
+        return 1;
+    }
+    benchmark::AddCustomContext("tag_encode.group_table", TAG_ENCODE_GROUP_TABLE ? "yes" : "no");
+    benchmark::AddCustomContext("tag_encode.batch_isa", tag_batch_isa());
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,15 @@
+-- tag_encode--1.0.sql: SQL functions of the tag_encode extension (see tag_encode_pg.cpp)
+
+\echo Use "CREATE EXTENSION tag_encode" to load this file. \quit
+
+CREATE FUNCTION tag_encode(bigint) RETURNS text
+    AS 'MODULE_PATHNAME', 'pg_tag_encode'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+COMMENT ON FUNCTION tag_encode(bigint) IS 'alphanumeric tag of a non-negative serial number';
+
+CREATE FUNCTION tag_decode(text) RETURNS bigint
+    AS 'MODULE_PATHNAME', 'pg_tag_decode'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+COMMENT ON FUNCTION tag_decode(text) IS 'serial number of a tag, or NULL if the tag is invalid';
@@ -0,0 +1,44 @@
+/**
+ * @file tag_encode.cpp
+ *
+ * Compiled form of "tag_encode.h" for building tag_encode as a static or
+ * shared library.  The library holds the batch encoder and decoders and the
+ * character classifier of `tag_scanner`, with all of their CPU-specific
+ * kernels (chosen at run time, see `tag_batch_isa()`); everything else in
+ * the header is inline or `constexpr` and stays there.
+ * Programs that link the library define `TAG_ENCODE_LIBRARY` before
+ * including the header.
+ *
+ * Build:
+ *     g++ -std=c++17 -O2 -fPIC -fvisibility=hidden -c tag_encode.cpp -o tag_encode.o
+ *     ar rcs libtag_encode.a tag_encode.o
+ *     g++ -shared -o libtag_encode.so tag_encode.o
+ *
+ * and link with:
+ *     g++ -std=c++17 -O2 -DTAG_ENCODE_LIBRARY program.cpp -L. -ltag_encode
+ *
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define TAG_ENCODE_BUILDING_LIBRARY
+#include "tag_encode.h"
@@ -44,15 +44,538 @@
 #define TAG_ENCODE_H
 
 #include<string>
-#include<sstream>
-#include<algorithm>
+#include<string_view>
+#include<vector>
+#include<optional>
 #include<exception>
-#include<cctype>
+#include<stdexcept>
+#include<limits>
+#include<type_traits>
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<algorithm>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include<span>
+#endif
+
+/*
+ * The SIMD batch kernels are compiled with per-function target attributes on
+ * x86-64 (GCC and Clang) and chosen at run time from the features of the CPU,
+ * so one binary runs the fastest kernel on every processor generation.
+ * Define `TAG_ENCODE_NO_DISPATCH` to compile only the kernels the compiler
+ * already targets (e.g. with -march=native).  Dispatch is also off under
+ * nvcc, whose device pass does not accept per-function targets.
+ */
+#if !defined(TAG_ENCODE_NO_DISPATCH) && !defined(__CUDACC__) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define TAG_ENCODE_DISPATCH 1
+#define TAG_ENCODE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TAG_ENCODE_DISPATCH 0
+#define TAG_ENCODE_TARGET(isa)
+#endif
+#if TAG_ENCODE_DISPATCH || (defined(__AVX512F__) && defined(__AVX512BW__))
+#define TAG_ENCODE_AVX512 1
+#else
+#define TAG_ENCODE_AVX512 0
+#endif
+#if TAG_ENCODE_DISPATCH || defined(__AVX2__)
+#define TAG_ENCODE_AVX2 1
+#else
+#define TAG_ENCODE_AVX2 0
+#endif
+#if TAG_ENCODE_DISPATCH || defined(__SSSE3__)
+#define TAG_ENCODE_SSSE3 1
+#else
+#define TAG_ENCODE_SSSE3 0
+#endif
+#if TAG_ENCODE_SSSE3 || TAG_ENCODE_AVX2 || TAG_ENCODE_AVX512
+#include<immintrin.h>
+#elif defined(__SSE2__)
+#include<emmintrin.h>
+#endif
+
+/*
+ * By default every function is defined inline in this header.  To use the
+ * compiled library instead (tag_encode.cpp, built as libtag_encode.a or
+ * libtag_encode.so), define `TAG_ENCODE_LIBRARY` in every translation unit
+ * that includes the header; the batch functions and their CPU-specific
+ * kernels are then only declared here.
+ */
+#if defined(TAG_ENCODE_BUILDING_LIBRARY)
+#if defined(__GNUC__) || defined(__clang__)
+#define TAG_ENCODE_API __attribute__((visibility("default")))
+#else
+#define TAG_ENCODE_API
+#endif
+#define TAG_ENCODE_LINKAGE TAG_ENCODE_API
+#else
+#define TAG_ENCODE_API
+#define TAG_ENCODE_LINKAGE inline
+#endif
+#if !defined(TAG_ENCODE_LIBRARY) || defined(TAG_ENCODE_BUILDING_LIBRARY)
+#define TAG_ENCODE_COMPILE_BATCH 1
+#else
+#define TAG_ENCODE_COMPILE_BATCH 0
+#endif
+
+/*
+ * Define `TAG_ENCODE_STATS` as 1 (the same way in every translation unit) to
+ * count the calls, decode failures by reason, tag lengths and sampled
+ * latencies of the single-tag encoders and decoders; see `tag_stats()`.
+ * One call in `TAG_ENCODE_STATS_SAMPLE` is timed.  Left at 0, no counting
+ * code is compiled at all.
+ */
+#ifndef TAG_ENCODE_STATS
+#define TAG_ENCODE_STATS 0
+#endif
+#ifndef TAG_ENCODE_STATS_SAMPLE
+#define TAG_ENCODE_STATS_SAMPLE 64
+#endif
+#if TAG_ENCODE_STATS
+#include<atomic>
+#include<mutex>
+#include<chrono>
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define TAG_ENCODE_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()   // counters are skipped in constant expressions
+#else
+#error "TAG_ENCODE_STATS requires __builtin_is_constant_evaluated()"
+#endif
+#endif
+
+constexpr int N_ALPHACASE   = 26;
+constexpr int N_ALPHANUM    = 34;
+constexpr int N_DIGITS      = 8;
+constexpr int BASE_SELECT[] = {N_ALPHANUM, N_ALPHACASE, N_DIGITS};
+
+namespace tag_encode_detail{
+    /**
+     * @brief  number of characters needed to encode the largest 'long int'
+     */
+    constexpr int max_tag_length(){
+        long int    limit  = std::numeric_limits<long int>::max();
+        long int    bound  = 1;                                                     // smallest serial that needs `length+1` chars
+        int         length = 0;
+        while(true){
+            int digit_base = BASE_SELECT[length++ % 3];
+            if(bound > limit / digit_base){                                         // the next bound would overflow, so every
+                return length;                                                      // 'long int' fits in `length` characters
+            }
+            bound *= digit_base;
+        }
+    }
+}
+
+/**
+ * @brief  maximum length of any tag produced by `tag_encode()` (15 for a 64-bit 'long int')
+ */
+constexpr int TAG_MAX_LENGTH = tag_encode_detail::max_tag_length();
+
+namespace tag_encode_detail{
+    /**
+     * @brief  precomputed tag-length thresholds
+     *
+     * `limit[L-1]` is the smallest serial number whose tag is longer than `L`
+     * characters (the last entry is a sentinel that no 'long int' reaches).
+     * `by_width[b]` is the tag length of the smallest serial whose binary
+     * representation is `b` bits wide.  Since every radix in `BASE_SELECT` is
+     * at least 8, no power-of-two interval contains more than one threshold.
+     */
+    struct length_table{
+        unsigned long int   limit[TAG_MAX_LENGTH];
+        unsigned char       by_width[std::numeric_limits<unsigned long int>::digits + 1];
+    };
+
+    constexpr length_table make_length_table(){
+        length_table table{};
+        unsigned long int bound = 1;
+        for(int length = 1; length < TAG_MAX_LENGTH; length++){
+            bound *= BASE_SELECT[(length - 1) % 3];
+            table.limit[length - 1] = bound;
+        }
+        table.limit[TAG_MAX_LENGTH - 1] = std::numeric_limits<unsigned long int>::max();
+        table.by_width[0] = 1;
+        for(int width = 1; width <= std::numeric_limits<unsigned long int>::digits; width++){
+            unsigned long int smallest = 1UL << (width - 1);
+            int               length   = 1;
+            while(smallest >= table.limit[length - 1]){
+                length++;
+            }
+            table.by_width[width] = length;
+        }
+        return table;
+    }
+
+    inline constexpr length_table LENGTHS = make_length_table();
+
+    /**
+     * @brief  true if every tag of up to `TAG_MAX_LENGTH` characters fits in an 'unsigned long long'
+     */
+    constexpr bool fits_accumulator(){
+        unsigned long long bound = 1;
+        for(int length = 0; length < TAG_MAX_LENGTH; length++){
+            if(bound > std::numeric_limits<unsigned long long>::max() / BASE_SELECT[length % 3]){
+                return false;
+            }
+            bound *= BASE_SELECT[length % 3];
+        }
+        return true;
+    }
+
+    static_assert(fits_accumulator(), "decoding accumulates tags in an 'unsigned long long'");
+
+    /**
+     * @brief  number of significant bits in a non-negative value
+     */
+    constexpr int bit_width(unsigned long int value){
+#if defined(__GNUC__) || defined(__clang__)
+        return value == 0 ? 0 : std::numeric_limits<unsigned long int>::digits - __builtin_clzl(value);
+#else
+        int width = 0;
+        for(; value != 0; value >>= 1){
+            width++;
+        }
+        return width;
+#endif
+    }
+}
+
+constexpr int TAG_STATS_LENGTHS  = 32;                                              // tag-length buckets: 0 to 30 characters, then 31 or more
+constexpr int TAG_STATS_BUCKETS  = 32;                                              // latency bucket `b` counts [2^(b-1), 2^b) ticks
+constexpr int TAG_STATS_STATUSES = 6;                                               // one per `tag_decode_status`
+
+#if TAG_ENCODE_STATS
+namespace tag_encode_detail{
+    enum stats_op{
+        stats_encode,
+        stats_decode
+    };
+
+    /**
+     * @brief  every counter, by operation where it applies
+     */
+    struct stats_counters{
+        std::atomic<std::uint64_t> calls[2];
+        std::atomic<std::uint64_t> status[TAG_STATS_STATUSES];
+        std::atomic<std::uint64_t> lengths[2][TAG_STATS_LENGTHS];
+        std::atomic<std::uint64_t> ticks[2][TAG_STATS_BUCKETS];
+        std::atomic<std::uint64_t> tick_sum[2];
+    };
+
+    /**
+     * @brief  one thread's counters, on cache lines of their own
+     *
+     * Only the owning thread writes them, with relaxed loads and stores (no
+     * locked instructions); `tag_stats()` reads them from any thread.
+     */
+    struct alignas(64) stats_shard : stats_counters{};
+
+    /**
+     * @brief  the shards of running threads, and the totals of threads that have exited
+     */
+    struct stats_registry{
+        std::mutex                lock;
+        std::vector<stats_shard*> live;
+        stats_counters            retired{};
+    };
+
+    inline stats_registry& stats_shards(){
+        static stats_registry* registry = new stats_registry;                      // never destroyed: threads may outlive static destructors
+        return *registry;
+    }
+
+    inline void stats_add(std::atomic<std::uint64_t>& counter, std::uint64_t n = 1) noexcept{
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief  add every counter of `from` into `to`
+     */
+    inline void stats_fold(const stats_counters& from, stats_counters& to) noexcept{
+        const std::atomic<std::uint64_t>* in  = &from.calls[0];
+        std::atomic<std::uint64_t>*       out = &to.calls[0];
+        for(std::size_t i = 0; i < sizeof(stats_counters) / sizeof(std::atomic<std::uint64_t>); i++){
+            stats_add(out[i], in[i].load(std::memory_order_relaxed));
+        }
+    }
+
+    /**
+     * @brief  registers the calling thread's shard on first use, and folds it into the totals at thread exit
+     */
+    struct stats_owner{
+        stats_shard* shard = new stats_shard{};
+
+        stats_owner(){
+            std::lock_guard<std::mutex> guard(stats_shards().lock);
+            stats_shards().live.push_back(shard);
+        }
+
+        ~stats_owner(){
+            stats_registry&             registry = stats_shards();
+            std::lock_guard<std::mutex> guard(registry.lock);
+            stats_fold(*shard, registry.retired);
+            registry.live.erase(std::find(registry.live.begin(), registry.live.end(), shard));
+            delete shard;
+        }
+    };
+
+    inline stats_shard& local_stats(){
+        thread_local stats_owner owner;
+        return *owner.shard;
+    }
+
+    /**
+     * @brief  time stamp for latency samples: the TSC on x86, nanoseconds elsewhere
+     */
+    inline std::uint64_t stats_ticks() noexcept{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        return __builtin_ia32_rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /**
+     * @brief  count a call; returns its start time if the call is sampled, or 0
+     */
+    inline std::uint64_t stats_begin(stats_op op){
+        stats_shard&  shard = local_stats();
+        std::uint64_t calls = shard.calls[op].load(std::memory_order_relaxed);
+        shard.calls[op].store(calls + 1, std::memory_order_relaxed);
+        return calls % TAG_ENCODE_STATS_SAMPLE == 0 ? stats_ticks() : 0;
+    }
+
+    /**
+     * @brief  record the tag length, decode status (or -1) and, if sampled, the latency of a call
+     */
+    inline void stats_end(stats_op op, std::uint64_t start, std::size_t length, int status){
+        std::uint64_t end   = start != 0 ? stats_ticks() : 0;
+        stats_shard&  shard = local_stats();
+        stats_add(shard.lengths[op][std::min<std::size_t>(length, TAG_STATS_LENGTHS - 1)]);
+        if(status >= 0){
+            stats_add(shard.status[status]);
+        }
+        if(start != 0){
+            stats_add(shard.ticks[op][std::min(bit_width(end - start), TAG_STATS_BUCKETS - 1)]);
+            stats_add(shard.tick_sum[op], end - start);
+        }
+    }
+}
+
+#define TAG_ENCODE_STATS_BEGIN(op)      std::uint64_t tag_stats_start = TAG_ENCODE_CONSTANT_EVALUATED() ? 0 : \
+                                            tag_encode_detail::stats_begin(tag_encode_detail::stats_##op)
+#define TAG_ENCODE_STATS_END(op, length, status) \
+    if(!TAG_ENCODE_CONSTANT_EVALUATED()){ tag_encode_detail::stats_end(tag_encode_detail::stats_##op, tag_stats_start, length, status); }
+#else
+#define TAG_ENCODE_STATS_BEGIN(op)
+#define TAG_ENCODE_STATS_END(op, length, status)
+#endif
+
+/**
+ * @brief  number of characters in the tag `tag_encode()` produces for a serial number
+ *
+ * Answers in constant time from a table of precomputed length thresholds
+ * (one lookup by bit width and a single comparison), so output buffers can
+ * be sized before encoding.
+ *
+ * @throw  std::out_of_range    thrown if the serial number is negative
+ *
+ * @param  serial non-negative integer serial number
+ * @return        length of the corresponding tag, between 1 and `TAG_MAX_LENGTH`
+ */
+constexpr std::size_t tag_encoded_length(long int serial){
+    if(serial < 0){
+        throw std::out_of_range("Serial number must be non-negative.");
+    }
+    unsigned long int value  = serial;
+    int               length = tag_encode_detail::LENGTHS.by_width[tag_encode_detail::bit_width(value)];
+    return length + (value >= tag_encode_detail::LENGTHS.limit[length - 1] ? 1 : 0);
+}
+
+#ifndef TAG_ENCODE_GROUP_TABLE
+#define TAG_ENCODE_GROUP_TABLE 1                                                     // 0 selects the per-character reference loop
+#endif
+
+namespace tag_encode_detail{
+    /**
+     * @brief  radix of one three-character group (8 * 26 * 34 = 7072)
+     *
+     * The radix schedule in `BASE_SELECT` repeats every three positions, so
+     * each run of three output characters is a single base-7072 digit.
+     */
+    constexpr int GROUP_BASE = N_ALPHANUM * N_ALPHACASE * N_DIGITS;
+
+    /**
+     * @brief  ASCII character for one digit at a position of the given radix
+     */
+    constexpr char digit_char(int digit, int digit_base){
+        if(digit_base == N_ALPHACASE){
+            return 'a' + digit;
+        }
+        return digit < N_DIGITS ? '2' + digit : 'a' + (digit - N_DIGITS);          // Base digit is '2' because both '0' and '1' are
+    }                                                                               // ambiguous in comparison to 'O' and 'l'.
+
+    /**
+     * @brief  the three characters (most-significant first) of every base-7072 group
+     */
+    struct group_table{
+        char triplet[GROUP_BASE][3];
+    };
+
+    constexpr group_table make_group_table(){
+        group_table table{};
+        for(int group = 0; group < GROUP_BASE; group++){
+            table.triplet[group][2] = digit_char(group % N_ALPHANUM, N_ALPHANUM);
+            table.triplet[group][1] = digit_char(group / N_ALPHANUM % N_ALPHACASE, N_ALPHACASE);
+            table.triplet[group][0] = digit_char(group / (N_ALPHANUM * N_ALPHACASE), N_DIGITS);
+        }
+        return table;
+    }
+
+    inline constexpr group_table GROUPS = make_group_table();
+
+    /**
+     * @brief  locale-independent case folding, with '0' read as 'o' and '1' as 'l'
+     */
+    constexpr char fold_char(char c){
+        if(c == '0'){                                                               // "user-proof" 0's as o's
+            return 'o';
+        }
+        if(c == '1'){                                                               // and 1's as l's
+            return 'l';
+        }
+        return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+    }
+
+    constexpr unsigned char INVALID_DIGIT = 0xFF;
+
+    /**
+     * @brief  digit value of every input byte, per position class
+     *
+     * `value[k][c]` is the digit that byte `c` denotes at a position of radix
+     * `BASE_SELECT[k]`, or `INVALID_DIGIT` if that byte may not appear there.
+     * Case folding and the '0'/'1' aliases are built in.
+     */
+    struct decode_table{
+        unsigned char value[3][256];
+    };
+
+    constexpr decode_table make_decode_table(){
+        decode_table table{};
+        for(int k = 0; k < 3; k++){
+            for(int c = 0; c < 256; c++){
+                char folded       = fold_char(static_cast<char>(c));
+                table.value[k][c] = INVALID_DIGIT;
+                for(int digit = 0; digit < BASE_SELECT[k]; digit++){
+                    if(digit_char(digit, BASE_SELECT[k]) == folded){
+                        table.value[k][c] = digit;
+                    }
+                }
+            }
+        }
+        return table;
+    }
+
+    inline constexpr decode_table DIGITS = make_decode_table();
+
+    /**
+     * @brief  reference encoder: one division per character, written backwards from `tag_end`
+     */
+    constexpr void encode_digits(long int serial, char* tag_end){
+        int    digit      = 0, digit_base = 0;
+        int    position = 0;
+        do{
+            digit_base = BASE_SELECT[position++ % 3];
+            digit      = serial % digit_base;
+            serial    /= digit_base;
+            *--tag_end = digit_char(digit, digit_base);
+        }while(serial > 0);
+    }
+
+    /**
+     * @brief  copy characters with `memcpy`, or element by element in constant expressions
+     */
+    constexpr void copy_chars(char* to, const char* from, int count){
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+        if(!__builtin_is_constant_evaluated()){
+            std::memcpy(to, from, count);
+            return;
+        }
+#endif
+        for(int j = 0; j < count; j++){
+            to[j] = from[j];
+        }
+    }
+
+    /**
+     * @brief  table encoder for any unsigned type the compiler divides by a constant without a library call
+     */
+    template<typename Unsigned>
+    constexpr void encode_unsigned(Unsigned value, char* tag_end){
+        while(value >= GROUP_BASE){
+            tag_end -= 3;
+            copy_chars(tag_end, GROUPS.triplet[value % GROUP_BASE], 3);
+            value   /= GROUP_BASE;
+        }
+        int length = value < N_ALPHANUM ? 1 : (value < N_ALPHANUM * N_ALPHACASE ? 2 : 3);
+        copy_chars(tag_end - length, GROUPS.triplet[value] + 3 - length, length);   // leading group without its zero padding
+    }
+
+    /**
+     * @brief  table encoder: one division per three characters, written backwards from `tag_end`
+     */
+    constexpr void encode_groups(long int serial, char* tag_end){
+        encode_unsigned<unsigned long int>(serial, tag_end);                        // unsigned division by a constant is cheaper
+    }
+}
+
+/**
+ * @brief  encode a non-negative integer into a caller-supplied character buffer
+ * 
+ * Allocation-free form of `tag_encode()`.  The tag is written right-aligned
+ * into the last `tag_encoded_length(serial)` bytes of `out`; no terminating
+ * NUL is written.  A buffer of `TAG_MAX_LENGTH` bytes always suffices, and a
+ * buffer sized exactly with `tag_encoded_length()` receives the tag at its
+ * start.
+ *
+ * @remark  Characters are produced three at a time from a precomputed table
+ *          of base-7072 groups.  Define `TAG_ENCODE_GROUP_TABLE` as 0 to use
+ *          the per-character reference loop instead.  Usable in constant
+ *          expressions; see also `tag_constant`.
+ *
+ * @throw  std::out_of_range    thrown if the serial number is negative
+ * @throw  std::length_error    thrown if `out_size` is smaller than the tag length
+ * 
+ * @param  serial   non-negative integer serial number to convert to alphanumeric "tag"
+ * @param  out      buffer receiving the tag characters
+ * @param  out_size size of `out` in bytes
+ * @return          number of characters written (the tag length)
+ */
+constexpr std::size_t tag_encode(long int serial, char* out, std::size_t out_size){
+    TAG_ENCODE_STATS_BEGIN(encode);
+    std::size_t length = tag_encoded_length(serial);
+    if(out_size < length){
+        throw std::length_error("Output buffer is too small for tag.");
+    }
+#if TAG_ENCODE_GROUP_TABLE
+    tag_encode_detail::encode_groups(serial, out + out_size);
+#else
+    tag_encode_detail::encode_digits(serial, out + out_size);
+#endif
+    TAG_ENCODE_STATS_END(encode, length, -1);
+    return length;
+}
 
-const int N_ALPHACASE   = 26;
-const int N_ALPHANUM    = 34;
-const int N_DIGITS      = 8;
-const int BASE_SELECT[] = {N_ALPHANUM, N_ALPHACASE, N_DIGITS};
+#if __cplusplus >= 202002L && __has_include(<span>)
+/**
+ * @brief  encode a non-negative integer right-aligned into a `std::span<char>`
+ *
+ * @see    tag_encode(long int, char*, std::size_t)
+ */
+inline std::size_t tag_encode(long int serial, std::span<char> out){
+    return tag_encode(serial, out.data(), out.size());
+}
+#endif
 
 /**
  * @brief  encode a non-negative integer into alphanumeric "tag" string
@@ -76,99 +599,3029 @@ const int BASE_SELECT[] = {N_ALPHANUM, N_ALPHACASE, N_DIGITS};
  * @param  serial non-negative integer serial number to convert to alphanumeric "tag"
  * @return        alphanumeric "tag" string that is both web- and human-friendly
  */
-std::string tag_encode(long int serial){
-    if(serial < 0){
+inline std::string tag_encode(long int serial){
+    char        tag[TAG_MAX_LENGTH];
+    std::size_t length = tag_encode(serial, tag, TAG_MAX_LENGTH);
+    return std::string(tag + TAG_MAX_LENGTH - length, length);                      // tags fit the small-string buffer
+}
+
+namespace tag_encode_detail{
+    /**
+     * @brief  NUL-terminated tag characters computed at compile time
+     */
+    template<std::size_t length>
+    struct static_tag{
+        char chars[length + 1];
+    };
+
+    template<long int serial>
+    constexpr static_tag<tag_encoded_length(serial)> make_static_tag(){
+        static_tag<tag_encoded_length(serial)> tag{};
+        tag_encode(serial, tag.chars, tag_encoded_length(serial));
+        return tag;
+    }
+
+    template<long int serial>
+    inline constexpr static_tag<tag_encoded_length(serial)> STATIC_TAG = make_static_tag<serial>();
+}
+
+/**
+ * @brief  the tag of a serial number, encoded at compile time
+ *
+ * `tag_constant<2147483646>` is a `std::string_view` of "ba9n82dq" that
+ * refers to static storage (and is NUL-terminated), so fixed tags cost
+ * nothing at run time and need no static initialization.  A negative
+ * serial number is a compile error.
+ */
+template<long int serial>
+inline constexpr std::string_view tag_constant{tag_encode_detail::STATIC_TAG<serial>.chars, tag_encoded_length(serial)};
+
+namespace tag_encode_detail{
+    /**
+     * @brief  zero digits of every position class, rightmost position last
+     *
+     * A padded tag of width `w` starts with the last `w - length` characters.
+     */
+    struct padding_table{
+        char chars[TAG_MAX_LENGTH];
+    };
+
+    constexpr padding_table make_padding_table(){
+        padding_table table{};
+        for(int position = 0; position < TAG_MAX_LENGTH; position++){
+            table.chars[TAG_MAX_LENGTH - 1 - position] = digit_char(0, BASE_SELECT[position % 3]);
+        }
+        return table;
+    }
+
+    inline constexpr padding_table PADDING = make_padding_table();
+
+    /**
+     * @brief  true if characters ascend (as unsigned bytes) with digit value in every position class
+     *
+     * This is what makes padded tags of one width sort like their serials.
+     */
+    constexpr bool digits_ascend(){
+        for(int digit_base : BASE_SELECT){
+            for(int digit = 1; digit < digit_base; digit++){
+                if(static_cast<unsigned char>(digit_char(digit - 1, digit_base)) >=
+                   static_cast<unsigned char>(digit_char(digit, digit_base))){
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static_assert(digits_ascend(), "tag characters must ascend with their digit values");
+}
+
+/**
+ * @brief  encode a non-negative integer into a fixed-width tag
+ *
+ * Writes exactly `width` characters to `out`: the tag of `serial`, left-padded
+ * with the zero digit of each position's class ('2' at digit and alphanumeric
+ * positions, 'a' at alphabetic ones), so "ba9n82dq" at width 10 is
+ * "22ba9n82dq".  Padding keeps the alternation of letters and digits, and
+ * every serial has exactly one padded tag per width, so fixed-width tags can
+ * be stored in fixed-size slots and compared with `memcmp` (an 8-character
+ * tag fits a single 64-bit word).  No terminating NUL is written.  Decode
+ * with `tag_try_decode_padded()`.  Usable in constant expressions.
+ *
+ * @remark  Padded tags of the same width sort in serial order: within each
+ *          position class the characters ascend with their digit values
+ *          ('2'-'9' then 'a'-'z'), so `memcmp` (or `std::string` comparison)
+ *          on tags padded to a common width -- `TAG_MAX_LENGTH` covers every
+ *          serial -- agrees with integer comparison.  Tag-keyed indexes can
+ *          then be range-scanned and merge-joined without decoding.
+ *
+ * @throw  std::out_of_range    thrown if the serial number is negative
+ * @throw  std::length_error    thrown if `width` is shorter than the tag or longer than `TAG_MAX_LENGTH`
+ *
+ * @param  serial   non-negative integer serial number to convert to alphanumeric "tag"
+ * @param  out      buffer receiving exactly `width` characters
+ * @param  width    width of the padded tag, at most `TAG_MAX_LENGTH`
+ * @return          `width`
+ */
+constexpr std::size_t tag_encode_padded(long int serial, char* out, std::size_t width){
+    if(width > static_cast<std::size_t>(TAG_MAX_LENGTH)){
+        throw std::length_error("Padded tag width exceeds TAG_MAX_LENGTH.");
+    }
+    std::size_t length = tag_encode(serial, out, width);
+    tag_encode_detail::copy_chars(out, tag_encode_detail::PADDING.chars + TAG_MAX_LENGTH - width, width - length);
+    return width;
+}
+
+/**
+ * @brief  encode a non-negative integer into a fixed-width tag string
+ *
+ * @see    tag_encode_padded(long int, char*, std::size_t)
+ *
+ * @param  serial non-negative integer serial number to convert to alphanumeric "tag"
+ * @param  width  width of the padded tag, at most `TAG_MAX_LENGTH`
+ * @return        the tag of `serial`, left-padded to `width` characters
+ */
+inline std::string tag_encode_padded(long int serial, std::size_t width){
+    char tag[TAG_MAX_LENGTH];                                                       // widths beyond it throw before writing
+    return std::string(tag, tag_encode_padded(serial, tag, width));
+}
+
+/**
+ * @brief  compare two tags in the order of their serial numbers
+ *
+ * Canonical tags have no leading zero digit, so a shorter tag always has a
+ * smaller serial and tags of equal length sort like their padded forms.
+ * This orders unpadded tag columns without decoding them.  Both tags must be
+ * as written by `tag_encode()` (lowercase, no aliases); for padded tags of a
+ * common width, plain `memcmp` already gives the same order.
+ *
+ * @param  a    tag produced by `tag_encode()`
+ * @param  b    tag produced by `tag_encode()`
+ * @return      negative, zero or positive as the serial of `a` is less than,
+ *              equal to or greater than the serial of `b`
+ */
+constexpr int tag_compare(std::string_view a, std::string_view b) noexcept{
+    if(a.size() != b.size()){
+        return a.size() < b.size() ? -1 : 1;
+    }
+    return a.compare(b);
+}
+
+/**
+ * @brief  one piece of a serial range's cover: every padded tag that starts
+ *         with `prefix` followed by a character from `first` to `last`
+ *
+ * As a key range this is `[prefix + first, prefix + last]` over the first
+ * `prefix.size() + 1` characters of each key.  The characters in between are
+ * those of the position's class, which skip from '9' to 'a' at alphanumeric
+ * positions; no tag holds the ASCII characters in the gap.
+ */
+struct tag_prefix_range{
+    std::string prefix;
+    char        first;
+    char        last;
+};
+
+/**
+ * @brief  cover a range of serial numbers with as few tag prefix ranges as possible
+ *
+ * Splits the inclusive range `[lo, hi]` along the radix boundaries of the
+ * padded tags of `width` characters.  Every serial from `lo` to `hi`, and no
+ * other, has a padded tag (see `tag_encode_padded()`) in exactly one piece
+ * of the result.  A run of whole sub-blocks that fills its parent is
+ * replaced by the parent, so no piece can be merged with another.  At most
+ * two pieces are produced per character position -- one on each side of the
+ * range -- and a piece one position up covers 34, 26 or 8 times as many
+ * serials.  The pieces are returned in ascending order, so they can be
+ * issued as index range scans in sequence.  Use `tag_range_prefixes()` for
+ * stores that only support prefix queries.
+ *
+ * @throw  std::out_of_range    thrown if `lo` is negative
+ * @throw  std::length_error    thrown if `width` is 0 or longer than `TAG_MAX_LENGTH`,
+ *                              or `hi` has no padded tag of `width` characters
+ *
+ * @param  lo       smallest serial number of the range
+ * @param  hi       largest serial number of the range; an empty result if below `lo`
+ * @param  width    width of the padded tags being searched
+ * @return          the pieces of the cover, in ascending order
+ */
+inline std::vector<tag_prefix_range> tag_range_cover(long int lo, long int hi, std::size_t width = TAG_MAX_LENGTH){
+    if(width < 1 || width > static_cast<std::size_t>(TAG_MAX_LENGTH)){
+        throw std::length_error("Padded tag width must be between 1 and TAG_MAX_LENGTH.");
+    }
+    if(lo < 0){
         throw std::out_of_range("Serial number must be non-negative.");
     }
-    std::ostringstream tag;
-    char   digit_in_ascii;
-    int    digit, digit_base;
-    int    position = 0;
-    do{
-        digit_base = BASE_SELECT[position++ % 3];
-        digit      = serial % digit_base;
-        serial    /= digit_base;
-        digit_in_ascii = (digit_base != N_ALPHACASE) ? '2' + digit : 'a' + digit;   // Base digit is '2' because both '0' and '1' are 
-        if(digit_base != N_ALPHACASE && digit_in_ascii > '9'){                      // ambiguous in comparison to 'O' and 'l'.
-            digit_in_ascii = 'a' + (digit - N_DIGITS);
+    std::vector<tag_prefix_range> pieces, right;                                    // `right` is built from the top down
+    if(hi < lo){
+        return pieces;
+    }
+    unsigned long int block[TAG_MAX_LENGTH + 1] = {1};                              // serials sharing every position from `p` up
+    for(int p = 0; p < TAG_MAX_LENGTH; p++){
+        block[p + 1] = block[p] * BASE_SELECT[p % 3];                               // 7072^5 still fits 64 bits
+    }
+    if(static_cast<unsigned long int>(hi) >= block[width]){
+        throw std::length_error("Serial number does not fit the padded width.");
+    }
+    auto piece = [width](std::size_t p, unsigned long int begin, unsigned long int end){
+        char        from[TAG_MAX_LENGTH], to[TAG_MAX_LENGTH];                       // blocks [begin, end) share their parent
+        std::size_t at = width - 1 - p;
+        tag_encode_padded(begin, from, width);
+        tag_encode_padded(end - 1, to, width);
+        return tag_prefix_range{std::string(from, at), from[at], to[at]};
+    };
+    unsigned long int begin = lo, end = hi + 1ul;                                   // half-open, aligned to `block[p]` below
+    for(std::size_t p = 0; begin < end; p++){
+        unsigned long int parent = block[p + 1];
+        bool              whole  = begin % parent == 0 && end % parent == 0;        // then covered one position up
+        if(p + 1 == width || (!whole && begin / parent == (end - 1) / parent)){
+            pieces.push_back(piece(p, begin, end));
+            break;
+        }
+        if(begin % parent != 0){
+            unsigned long int up = (begin / parent + 1) * parent;
+            pieces.push_back(piece(p, begin, up));
+            begin = up;
+        }
+        if(end % parent != 0){
+            unsigned long int down = end / parent * parent;
+            right.push_back(piece(p, down, end));
+            end = down;
+        }
+    }
+    pieces.insert(pieces.end(), right.rbegin(), right.rend());
+    return pieces;
+}
+
+/**
+ * @brief  cover a range of serial numbers with plain tag prefixes
+ *
+ * `tag_range_cover()` with every piece expanded into one prefix per
+ * character, for stores that answer only prefix queries (object-store
+ * listings, prefix filters).  At most 2 * (33 + 25 + 7) prefixes per three
+ * characters of width, and usually far fewer.
+ *
+ * @see    tag_range_cover()
+ *
+ * @param  lo       smallest serial number of the range
+ * @param  hi       largest serial number of the range
+ * @param  width    width of the padded tags being searched
+ * @return          prefixes in ascending order; every padded tag in the range has exactly one
+ */
+inline std::vector<std::string> tag_range_prefixes(long int lo, long int hi, std::size_t width = TAG_MAX_LENGTH){
+    using namespace tag_encode_detail;
+    std::vector<std::string> prefixes;
+    for(const tag_prefix_range& range : tag_range_cover(lo, hi, width)){
+        int k = (width - 1 - range.prefix.size()) % 3;                              // position class of the varying character
+        for(int digit = DIGITS.value[k][static_cast<unsigned char>(range.first)];
+            digit <= DIGITS.value[k][static_cast<unsigned char>(range.last)]; digit++){
+            prefixes.push_back(range.prefix + digit_char(digit, BASE_SELECT[k]));
+        }
+    }
+    return prefixes;
+}
+
+namespace tag_encode_detail{
+    /**
+     * @brief  step a tag character to the next digit of its position class
+     *
+     * @return  false if the character wrapped around to the zero digit (a carry)
+     */
+    constexpr bool increment_char(char& c, int digit_base){
+        if(c == digit_char(digit_base - 1, digit_base)){
+            c = digit_char(0, digit_base);
+            return false;
         }
-        tag << digit_in_ascii;
-    }while(serial > 0);
-    std::string tag_str = tag.str();                                                // order is big-endian now...
-    std::reverse(tag_str.begin(), tag_str.end());                                   // so convert to little-endian
-    return tag_str;
+        c = (c == '9') ? 'a' : c + 1;                                               // alphanumeric positions continue from '9' to 'a'
+        return true;
+    }
 }
 
 /**
- * @brief  decode an alphanumeric "tag" string into its corresponding integer
- * 
- * Decode a "tag" produced by the `tag_encode` function into its corresponding
- * non-negative integer.  For robustness, this function will accept upper- and
- * lower-case versions of the tag string, and converts often-mistaken characters
- * '0' and '1' into 'O' and 'l' on-the-fly.
+ * @brief  generator of the tags of consecutive serial numbers
  *
- * @remark  The tag encoding is web-safe, using only the characters
- *          a-z2-9.  The digits '0' and '1' are NOT used, since they are easily
- *          visually confused with the characters 'O' and 'l'.  Tags are not case-
- *          sensitive, but are always generated with lowercase characters.
- *          Additionally, this scheme always guarentees that there is are never more
- *          than two consecutive alphabetical characters, thereby avoiding the need
- *          to blacklist any "impolite" words.  Also, there are never more than two
- *          consecutive numbers, avoiding "big number" appearance.
- *          These tags are shorter than the serial numbers produced:
- *          (MAX_INT  of          2147483646 encodes as ba9n82dq        -- 8 characters!)
- *          (Max long of 9223372036854775806 encodes as 6eh5g28yq5mi7bq -- 15 characters!)
+ * Holds the current tag in a small in-place buffer and steps it like an
+ * odometer, carrying through the `BASE_SELECT` radixes, so each increment
+ * costs amortized O(1) character updates with no division or allocation.
+ * The tags are identical to `tag_encode()` of the same serial numbers:
  *
- * @throw  std::invalid_argument    thrown if the tag is blank or if re-encoding the
- *                                  tag does not produce the same tag
- * 
- * @param  tag "tag" string as produced by the `tag_encode` function
- * @return     non-negative integer serial number corresponding to the input tag
+ *     for(tag_counter counter(first); counter.serial() < last; ++counter){
+ *         store(counter.serial(), counter.tag());
+ *     }
+ *
+ * The view returned by `tag()` (or `*counter`) refers to the counter's own
+ * buffer and is invalidated by the next increment.  Usable in constant
+ * expressions.
  */
-long int tag_decode(std::string tag){
-    if(tag.size() < 1){
-        throw std::invalid_argument("Tag cannot be blank.");
+class tag_counter{
+public:
+    /**
+     * @brief  start counting at `start`
+     *
+     * @throw  std::out_of_range    thrown if `start` is negative
+     */
+    constexpr explicit tag_counter(long int start = 0)
+        : tag_chars{}, current_serial(start), tag_length(tag_encode(start, tag_chars, TAG_MAX_LENGTH)){}
+
+    /**
+     * @brief  the tag of the current serial number
+     */
+    constexpr std::string_view tag() const noexcept{
+        return std::string_view(tag_chars + TAG_MAX_LENGTH - tag_length, tag_length);
     }
-    int      digit, digit_base;
-    char     digit_in_ascii;
-    long int serial   = 0;
-    int      position = 0;
-    int      tag_size = tag.size();
-    long int mult     = 1;
-    bool     check    = true;
-                                                                                    // "user-proof" pre-process:
-    for(size_t pos = tag.find("0"); pos != std::string::npos; pos = tag.find("0", pos+1)){
-        tag.replace(pos, 1, "O");                                                   // replace all 0's with o's
+
+    constexpr std::string_view operator*() const noexcept{
+        return tag();
     }
-    for(size_t pos = tag.find("1"); pos != std::string::npos; pos = tag.find("1", pos+1)){
-        tag.replace(pos, 1, "l");                                                   // and all 1's with l's 
+
+    /**
+     * @brief  the current serial number
+     */
+    constexpr long int serial() const noexcept{
+        return current_serial;
     }
 
-    do{
-        digit_base     = BASE_SELECT[position++ % 3];
-        digit_in_ascii = tag[tag_size - position] = tolower(tag[tag_size - position]);
-        if(digit_base == N_ALPHACASE || digit_in_ascii > '9'){
-            digit = digit_in_ascii - 'a' + ( (digit_base != N_ALPHACASE) ? N_DIGITS : 0 );
+    /**
+     * @brief  step to the next serial number
+     *
+     * @throw  std::overflow_error  thrown if the current serial is the largest 'long int'
+     */
+    constexpr tag_counter& operator++(){
+        if(current_serial == std::numeric_limits<long int>::max()){
+            throw std::overflow_error("Tag counter cannot pass the largest 'long int'.");
         }
-        else{
-            digit = digit_in_ascii - '2';
+        current_serial++;
+        char* c = tag_chars + TAG_MAX_LENGTH - 1;                                   // rightmost character
+        int   k = 0;                                                                // its position class
+        for(std::size_t position = 0; ; position++, c--, k = (k == 2) ? 0 : k + 1){
+            if(position == tag_length){                                             // carried past the leading character:
+                *c = tag_encode_detail::digit_char(1, BASE_SELECT[k]);              // the tag grows by a digit 1
+                tag_length++;
+                break;
+            }
+            if(tag_encode_detail::increment_char(*c, BASE_SELECT[k])){
+                break;                                                              // no carry
+            }
         }
-        serial += digit * mult;
-        mult   *= digit_base;
-    }while(position < tag_size);
+        return *this;
+    }
+
+    constexpr tag_counter operator++(int){
+        tag_counter previous = *this;
+        ++*this;
+        return previous;
+    }
 
-    try{                                                                            // if the string is re-encoded
-        if(tag_encode(serial) != tag){                                              // but doesn't match the original,
-            check = false;                                                          // that is a problem...
+    /**
+     * @brief  skip ahead `n` serial numbers (the tag is re-encoded, costing O(tag length))
+     *
+     * @throw  std::out_of_range    thrown if `n` is negative
+     * @throw  std::overflow_error  thrown if the result would exceed the largest 'long int'
+     */
+    constexpr tag_counter& advance(long int n){
+        if(n < 0){
+            throw std::out_of_range("Tag counter cannot advance by a negative count.");
         }
-    }catch(std::out_of_range) { check = false; }                                    // if we generate a negative somehow, that's bad too
-    if(!check){                                                                     // Any kind of mismatch creates an exception
-        throw std::invalid_argument(
-            std::string("Invalid input tag: \"") + tag + "\""
-        );      
+        if(n > std::numeric_limits<long int>::max() - current_serial){
+            throw std::overflow_error("Tag counter cannot pass the largest 'long int'.");
+        }
+        current_serial += n;
+        tag_length      = tag_encode(current_serial, tag_chars, TAG_MAX_LENGTH);
+        return *this;
+    }
+
+    constexpr bool operator==(const tag_counter& other) const noexcept{
+        return current_serial == other.current_serial;
+    }
+
+    constexpr bool operator!=(const tag_counter& other) const noexcept{
+        return current_serial != other.current_serial;
+    }
+
+private:
+    char        tag_chars[TAG_MAX_LENGTH];                                          // tag right-aligned at the end
+    long int    current_serial;
+    std::size_t tag_length;
+};
+
+/**
+ * @brief  compute the Arrow-style offsets of a column of tags before encoding it
+ *
+ * First half of the two-pass columnar encoder.  Writes `offsets[1]` through
+ * `offsets[n]` as the running end of each tag, starting from the value
+ * already in `offsets[0]` (0 for a new column, or the end of the data when
+ * appending), using the same constant-time length thresholds as
+ * `tag_encoded_length()`.  The return value is the exact size the data
+ * buffer must have for `tag_encode_column()`.
+ *
+ * @throw  std::out_of_range    thrown if any serial number is negative
+ * @throw  std::length_error    thrown if the column would exceed the 32-bit offset range
+ *
+ * @param  serials  non-negative serial numbers
+ * @param  n        number of serial numbers
+ * @param  offsets  `n + 1` offsets; `offsets[0]` must already be set
+ * @return          `offsets[n]`, the end of the last tag
+ */
+constexpr std::size_t tag_column_offsets(const std::int64_t* serials, std::size_t n, std::int32_t* offsets){
+    std::int64_t end = offsets[0];
+    for(std::size_t i = 0; i < n; i++){
+        end += tag_encoded_length(serials[i]);
+        if(end > std::numeric_limits<std::int32_t>::max()){
+            throw std::length_error("Tag column exceeds the 32-bit offset range.");
+        }
+        offsets[i + 1] = static_cast<std::int32_t>(end);
+    }
+    return end;
+}
+
+/**
+ * @brief  encode a column of serial numbers into one contiguous buffer
+ *
+ * Second half of the columnar encoder: tag `i` is written to
+ * `data[offsets[i]]` up to `data[offsets[i + 1]]`, with no separators and no
+ * terminating NUL, i.e. the value buffer of an Arrow string column.  The
+ * offsets must come from `tag_column_offsets()` for the same serials; the
+ * tags' lengths are taken from them rather than recomputed.
+ *
+ * @param  serials  non-negative serial numbers
+ * @param  n        number of serial numbers
+ * @param  data     value buffer of at least `offsets[n]` bytes
+ * @param  offsets  offsets produced by `tag_column_offsets()`
+ */
+constexpr void tag_encode_column(const std::int64_t* serials, std::size_t n, char* data, const std::int32_t* offsets) noexcept{
+    for(std::size_t i = 0; i < n; i++){
+#if TAG_ENCODE_GROUP_TABLE
+        tag_encode_detail::encode_groups(serials[i], data + offsets[i + 1]);        // written backwards from the end of the tag
+#else
+        tag_encode_detail::encode_digits(serials[i], data + offsets[i + 1]);
+#endif
+    }
+}
+
+/**
+ * @brief  a reusable column of tags in Arrow string layout
+ *
+ * Holds every tag of a batch in one character buffer plus `size() + 1`
+ * 32-bit offsets, so encoding a result set costs no allocation per row.
+ * `assign()` and `append()` size both buffers exactly before encoding, and
+ * `clear()` keeps their capacity, so a column reused across batches stops
+ * allocating once it has seen the largest one.  `data()` and `offsets()`
+ * can be handed directly to `tag_decode_batch()` or to an Arrow
+ * `StringArray`.
+ */
+class tag_column{
+public:
+    /**
+     * @brief  replace the contents with the tags of `n` serial numbers
+     *
+     * @throw  std::out_of_range    thrown if any serial number is negative
+     * @throw  std::length_error    thrown if the column would exceed the 32-bit offset range
+     */
+    void assign(const std::int64_t* serials, std::size_t n){
+        clear();
+        append(serials, n);
+    }
+
+    /**
+     * @brief  add the tags of `n` serial numbers after the current ones
+     *
+     * The column is unchanged if an exception is thrown.
+     *
+     * @throw  std::out_of_range    thrown if any serial number is negative
+     * @throw  std::length_error    thrown if the column would exceed the 32-bit offset range
+     */
+    void append(const std::int64_t* serials, std::size_t n){
+        std::size_t rows = size();
+        try{
+            ends.resize(rows + 1 + n);
+            chars.resize(tag_column_offsets(serials, n, ends.data() + rows));    // exact size, from the length thresholds
+        }catch(...){
+            ends.resize(rows + 1);
+            throw;
+        }
+        tag_encode_column(serials, n, chars.data(), ends.data() + rows);
+    }
+
+    /**
+     * @brief  remove every tag, keeping the allocated capacity
+     */
+    void clear() noexcept{
+        chars.clear();
+        ends.resize(1);
+    }
+
+    /**
+     * @brief  reserve room for `rows` tags totalling `bytes` characters
+     */
+    void reserve(std::size_t rows, std::size_t bytes){
+        ends.reserve(rows + 1);
+        chars.reserve(bytes);
+    }
+
+    std::size_t size() const noexcept{
+        return ends.size() - 1;
+    }
+
+    bool empty() const noexcept{
+        return ends.size() == 1;
+    }
+
+    /**
+     * @brief  the tag in row `i`, valid until the column is next modified
+     */
+    std::string_view operator[](std::size_t i) const noexcept{
+        return std::string_view(chars.data() + ends[i], ends[i + 1] - ends[i]);
+    }
+
+    /**
+     * @brief  the value buffer: every tag, back to back
+     */
+    const char* data() const noexcept{
+        return chars.data();
+    }
+
+    /**
+     * @brief  number of bytes in the value buffer (`offsets()[size()]`)
+     */
+    std::size_t data_size() const noexcept{
+        return chars.size();
+    }
+
+    /**
+     * @brief  `size() + 1` offsets into `data()`; row `i` spans `[offsets()[i], offsets()[i + 1])`
+     */
+    const std::int32_t* offsets() const noexcept{
+        return ends.data();
+    }
+
+private:
+    std::vector<char>           chars;
+    std::vector<std::int32_t>   ends = std::vector<std::int32_t>(1, 0);                // always starts with offset 0
+};
+
+/**
+ * @brief  bytes per tag in the fixed-stride output of `tag_encode_batch()`
+ */
+constexpr std::size_t TAG_BATCH_STRIDE = 16;
+
+namespace tag_encode_detail{
+    /**
+     * @brief  instruction sets of the batch kernels, in order of preference
+     */
+    enum class cpu_level{
+        scalar,
+        ssse3,                                                                      // batch decoders
+        avx2,                                                                       // batch encoder, SSSE3 decoders
+        avx512                                                                      // AVX-512 F and BW batch encoder, SSSE3 decoders
+    };
+
+    /**
+     * @brief  the best kernels the running CPU supports (without dispatch: the compiler targets)
+     */
+    inline cpu_level detect_cpu_level() noexcept{
+#if TAG_ENCODE_DISPATCH
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")){
+            return cpu_level::avx512;
+        }
+        if(__builtin_cpu_supports("avx2")){
+            return cpu_level::avx2;
+        }
+        if(__builtin_cpu_supports("ssse3")){
+            return cpu_level::ssse3;
+        }
+        return cpu_level::scalar;
+#elif TAG_ENCODE_AVX512
+        return cpu_level::avx512;
+#elif TAG_ENCODE_AVX2
+        return cpu_level::avx2;
+#elif TAG_ENCODE_SSSE3
+        return cpu_level::ssse3;
+#else
+        return cpu_level::scalar;
+#endif
+    }
+
+    /**
+     * @brief  `detect_cpu_level()`, evaluated once
+     */
+    inline cpu_level cpu() noexcept{
+        static const cpu_level level = detect_cpu_level();
+        return level;
+    }
+}
+
+/**
+ * @brief  name of the instruction set the batch functions use on this CPU
+ *
+ * One of "avx512", "avx2", "ssse3" or "scalar".  The batch encoder has
+ * AVX-512 and AVX2 kernels and the batch decoders SSSE3 kernels; each uses
+ * the best one at or below this level.
+ */
+TAG_ENCODE_API const char* tag_batch_isa() noexcept;
+
+#if TAG_ENCODE_COMPILE_BATCH
+TAG_ENCODE_LINKAGE const char* tag_batch_isa() noexcept{
+    switch(tag_encode_detail::cpu()){
+        case tag_encode_detail::cpu_level::avx512:  return "avx512";
+        case tag_encode_detail::cpu_level::avx2:    return "avx2";
+        case tag_encode_detail::cpu_level::ssse3:   return "ssse3";
+        default:                                    return "scalar";
+    }
+}
+
+namespace tag_encode_detail{
+    constexpr std::uint32_t LIMB_BASE = GROUP_BASE * GROUP_BASE;                    // two groups (six characters) per 32-bit limb
+
+    /**
+     * @brief  scalar batch encoder; the reference for the SIMD kernels
+     */
+    inline void encode_batch_scalar(const std::int64_t* in, std::size_t n, char* out, std::uint8_t* lens) noexcept{
+        for(std::size_t i = 0; i < n; i++){
+            char* slot = out + i * TAG_BATCH_STRIDE;
+            std::memset(slot, 0, TAG_BATCH_STRIDE);
+            if(in[i] < 0){
+                lens[i] = 0;                                                        // negative serials have no tag
+                continue;
+            }
+            lens[i] = tag_encoded_length(in[i]);
+            encode_groups(in[i], slot + lens[i]);
+        }
+    }
+
+    constexpr std::size_t BATCH_CHUNK = 256;                                        // serials split per pass of the SIMD kernels
+
+    /**
+     * @brief  split serials into three 32-bit limbs of radix 7072^2 and find their tag lengths
+     *
+     * Handles the 64-bit part of the work with two divisions by a constant
+     * per serial; every limb is then small enough for 32-bit SIMD lanes.
+     * Limb `k` of serial `i` is stored at `limbs[k * BATCH_CHUNK + i]`.  The
+     * SIMD kernels split a whole chunk before loading any of it, so their
+     * vector loads never wait on these scalar stores.
+     */
+    inline void split_limbs(const std::int64_t* in, std::size_t count, std::uint32_t* limbs, std::uint8_t* lens) noexcept{
+        for(std::size_t i = 0; i < count; i++){
+            std::uint64_t value = in[i] < 0 ? 0 : in[i];
+            std::uint64_t upper = value / LIMB_BASE;
+            lens[i]                        = in[i] < 0 ? 0 : tag_encoded_length(in[i]);
+            limbs[i]                       = value - upper * LIMB_BASE;
+            limbs[BATCH_CHUNK + i]         = upper % LIMB_BASE;
+            limbs[2 * BATCH_CHUNK + i]     = upper / LIMB_BASE;                     // < 7072 for any 63-bit serial
+        }
+    }
+
+    // Reciprocals for exact division by multiply-and-shift, verified over the full
+    // range each is applied to: limbs < 7072^2, groups < 7072, group / 34 < 208.
+    constexpr std::uint32_t RECIP_GROUP = 77736965, SHIFT_GROUP = 39;
+    constexpr std::uint32_t RECIP_34    = 15421,    SHIFT_34    = 19;
+    constexpr std::uint32_t RECIP_26    = 20165,    SHIFT_26    = 19;
+
+    // Once the characters of a serial sit in one 128-bit lane, least-significant
+    // first, shuffling byte `j` from index `length - 1 - j` puts the tag in order;
+    // for `j >= length` the index is negative, which makes `pshufb` write a NUL.
+
+#if TAG_ENCODE_AVX2
+    /**
+     * @brief  divide eight 32-bit limbs by 7072, returning quotients and remainders
+     */
+    TAG_ENCODE_TARGET("avx2") inline __m256i divide_limbs_avx2(__m256i limb, __m256i& remainder) noexcept{
+        const __m256i recip = _mm256_set1_epi32(RECIP_GROUP);
+        __m256i even  = _mm256_srli_epi64(_mm256_mul_epu32(limb, recip), SHIFT_GROUP);
+        __m256i odd   = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(limb, 32), recip), SHIFT_GROUP);
+        __m256i quot  = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+        remainder     = _mm256_sub_epi32(limb, _mm256_mullo_epi32(quot, _mm256_set1_epi32(GROUP_BASE)));
+        return quot;
+    }
+
+    /**
+     * @brief  the three characters of eight groups, as 32-bit lanes (radix 34, 26, 8 positions)
+     */
+    TAG_ENCODE_TARGET("avx2") inline void group_chars_avx2(__m256i group, __m256i chars[3]) noexcept{
+        __m256i upper  = _mm256_srli_epi32(_mm256_mullo_epi32(group, _mm256_set1_epi32(RECIP_34)), SHIFT_34);
+        __m256i top    = _mm256_srli_epi32(_mm256_mullo_epi32(upper, _mm256_set1_epi32(RECIP_26)), SHIFT_26);
+        __m256i d0     = _mm256_sub_epi32(group, _mm256_mullo_epi32(upper, _mm256_set1_epi32(N_ALPHANUM)));
+        __m256i d1     = _mm256_sub_epi32(upper, _mm256_mullo_epi32(top, _mm256_set1_epi32(N_ALPHACASE)));
+        __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi32(d0, _mm256_set1_epi32(N_DIGITS - 1)),
+                                          _mm256_set1_epi32('a' - N_DIGITS - '2'));   // radix-34 digits past '9' are letters
+        chars[0] = _mm256_add_epi32(_mm256_add_epi32(d0, _mm256_set1_epi32('2')), letter);
+        chars[1] = _mm256_add_epi32(d1, _mm256_set1_epi32('a'));
+        chars[2] = _mm256_add_epi32(top, _mm256_set1_epi32('2'));
+    }
+
+    /**
+     * @brief  pack four characters (32-bit lanes) into the bytes of each lane
+     */
+    TAG_ENCODE_TARGET("avx2") inline __m256i pack_chars_avx2(__m256i c0, __m256i c1, __m256i c2, __m256i c3) noexcept{
+        return _mm256_or_si256(_mm256_or_si256(c0, _mm256_slli_epi32(c1, 8)),
+                               _mm256_or_si256(_mm256_slli_epi32(c2, 16), _mm256_slli_epi32(c3, 24)));
+    }
+
+    /**
+     * @brief  reverse the tags of two serials (one per 128-bit lane) into place
+     */
+    TAG_ENCODE_TARGET("avx2") inline __m256i order_tags_avx2(__m256i chars, __m256i lens, int first) noexcept{
+        const __m256i position = _mm256_setr_epi8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+                                                  1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+        __m256i length = _mm256_shuffle_epi8(lens, _mm256_setr_m128i(_mm_set1_epi8(first), _mm_set1_epi8(first + 1)));
+        return _mm256_shuffle_epi8(chars, _mm256_sub_epi8(length, position));
+    }
+
+    /**
+     * @brief  AVX2 batch encoder: eight serials per vector
+     */
+    TAG_ENCODE_TARGET("avx2") inline void encode_batch_avx2(const std::int64_t* in, std::size_t n, char* out, std::uint8_t* lens) noexcept{
+        constexpr std::size_t LANES = 8;
+        alignas(32) std::uint32_t limbs[3 * BATCH_CHUNK];
+        std::size_t               i = 0;
+        while(n - i >= LANES){
+            std::size_t count = std::min(BATCH_CHUNK, (n - i) / LANES * LANES);
+            split_limbs(in + i, count, limbs, lens + i);
+            for(std::size_t j = 0; j < count; j += LANES){
+                __m256i g[5], c[5][3];
+                g[1] = divide_limbs_avx2(_mm256_load_si256(reinterpret_cast<const __m256i*>(limbs + j)), g[0]);
+                g[3] = divide_limbs_avx2(_mm256_load_si256(reinterpret_cast<const __m256i*>(limbs + BATCH_CHUNK + j)), g[2]);
+                g[4] = _mm256_load_si256(reinterpret_cast<const __m256i*>(limbs + 2 * BATCH_CHUNK + j));
+                for(int k = 0; k < 5; k++){
+                    group_chars_avx2(g[k], c[k]);
+                }
+                __m256i w0 = pack_chars_avx2(c[0][0], c[0][1], c[0][2], c[1][0]);   // character positions 0-3
+                __m256i w1 = pack_chars_avx2(c[1][1], c[1][2], c[2][0], c[2][1]);   // 4-7
+                __m256i w2 = pack_chars_avx2(c[2][2], c[3][0], c[3][1], c[3][2]);   // 8-11
+                __m256i w3 = pack_chars_avx2(c[4][0], c[4][1], c[4][2], _mm256_setzero_si256());
+                __m256i a  = _mm256_unpacklo_epi32(w0, w1), b = _mm256_unpacklo_epi32(w2, w3);
+                __m256i x  = _mm256_unpackhi_epi32(w0, w1), y = _mm256_unpackhi_epi32(w2, w3);
+                __m256i s0 = _mm256_unpacklo_epi64(a, b), s1 = _mm256_unpackhi_epi64(a, b);   // s_k: serials k, k+4
+                __m256i s2 = _mm256_unpacklo_epi64(x, y), s3 = _mm256_unpackhi_epi64(x, y);
+                __m256i ln = _mm256_broadcastsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(lens + i + j)));
+                __m256i* slot = reinterpret_cast<__m256i*>(out + (i + j) * TAG_BATCH_STRIDE);
+                _mm256_storeu_si256(slot,     order_tags_avx2(_mm256_permute2x128_si256(s0, s1, 0x20), ln, 0));
+                _mm256_storeu_si256(slot + 1, order_tags_avx2(_mm256_permute2x128_si256(s2, s3, 0x20), ln, 2));
+                _mm256_storeu_si256(slot + 2, order_tags_avx2(_mm256_permute2x128_si256(s0, s1, 0x31), ln, 4));
+                _mm256_storeu_si256(slot + 3, order_tags_avx2(_mm256_permute2x128_si256(s2, s3, 0x31), ln, 6));
+            }
+            i += count;
+        }
+        encode_batch_scalar(in + i, n - i, out + i * TAG_BATCH_STRIDE, lens + i);
+    }
+#endif
+
+#if TAG_ENCODE_AVX512
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"                             // GCC's false positive on the undefined pass-through of avx512fintrin.h
+#endif
+    TAG_ENCODE_TARGET("avx512f,avx512bw") inline __m512i divide_limbs_avx512(__m512i limb, __m512i& remainder) noexcept{
+        const __m512i recip = _mm512_set1_epi32(RECIP_GROUP);
+        __m512i even  = _mm512_srli_epi64(_mm512_mul_epu32(limb, recip), SHIFT_GROUP);
+        __m512i odd   = _mm512_srli_epi64(_mm512_mul_epu32(_mm512_srli_epi64(limb, 32), recip), SHIFT_GROUP);
+        __m512i quot  = _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32));
+        remainder     = _mm512_sub_epi32(limb, _mm512_mullo_epi32(quot, _mm512_set1_epi32(GROUP_BASE)));
+        return quot;
+    }
+
+    TAG_ENCODE_TARGET("avx512f,avx512bw") inline void group_chars_avx512(__m512i group, __m512i chars[3]) noexcept{
+        __m512i   upper  = _mm512_srli_epi32(_mm512_mullo_epi32(group, _mm512_set1_epi32(RECIP_34)), SHIFT_34);
+        __m512i   top    = _mm512_srli_epi32(_mm512_mullo_epi32(upper, _mm512_set1_epi32(RECIP_26)), SHIFT_26);
+        __m512i   d0     = _mm512_sub_epi32(group, _mm512_mullo_epi32(upper, _mm512_set1_epi32(N_ALPHANUM)));
+        __m512i   d1     = _mm512_sub_epi32(upper, _mm512_mullo_epi32(top, _mm512_set1_epi32(N_ALPHACASE)));
+        __mmask16 letter = _mm512_cmpgt_epi32_mask(d0, _mm512_set1_epi32(N_DIGITS - 1));
+        __m512i   digit  = _mm512_add_epi32(d0, _mm512_set1_epi32('2'));
+        chars[0] = _mm512_mask_add_epi32(digit, letter, digit, _mm512_set1_epi32('a' - N_DIGITS - '2'));   // radix-34 digits past '9' are letters
+        chars[1] = _mm512_add_epi32(d1, _mm512_set1_epi32('a'));
+        chars[2] = _mm512_add_epi32(top, _mm512_set1_epi32('2'));
+    }
+
+    TAG_ENCODE_TARGET("avx512f,avx512bw") inline __m512i pack_chars_avx512(__m512i c0, __m512i c1, __m512i c2, __m512i c3) noexcept{
+        return _mm512_or_si512(_mm512_or_si512(c0, _mm512_slli_epi32(c1, 8)),
+                               _mm512_or_si512(_mm512_slli_epi32(c2, 16), _mm512_slli_epi32(c3, 24)));
+    }
+
+    /**
+     * @brief  reverse the tags of four serials (one per 128-bit lane) into place
+     */
+    TAG_ENCODE_TARGET("avx512f,avx512bw") inline __m512i order_tags_avx512(__m512i chars, __m512i lens, int first) noexcept{
+        const __m512i position = _mm512_broadcast_i32x4(_mm_setr_epi8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16));
+        const __m512i lane     = _mm512_set_epi32(0x03030303, 0x03030303, 0x03030303, 0x03030303,
+                                                  0x02020202, 0x02020202, 0x02020202, 0x02020202,
+                                                  0x01010101, 0x01010101, 0x01010101, 0x01010101, 0, 0, 0, 0);
+        __m512i length = _mm512_shuffle_epi8(lens, _mm512_add_epi8(lane, _mm512_set1_epi8(first)));
+        return _mm512_shuffle_epi8(chars, _mm512_sub_epi8(length, position));
+    }
+
+    /**
+     * @brief  AVX-512 batch encoder: sixteen serials per vector
+     */
+    TAG_ENCODE_TARGET("avx512f,avx512bw") inline void encode_batch_avx512(const std::int64_t* in, std::size_t n, char* out, std::uint8_t* lens) noexcept{
+        constexpr std::size_t LANES = 16;
+        alignas(64) std::uint32_t limbs[3 * BATCH_CHUNK];
+        std::size_t               i = 0;
+        while(n - i >= LANES){
+            std::size_t count = std::min(BATCH_CHUNK, (n - i) / LANES * LANES);
+            split_limbs(in + i, count, limbs, lens + i);
+            for(std::size_t j = 0; j < count; j += LANES){
+                __m512i g[5], c[5][3];
+                g[1] = divide_limbs_avx512(_mm512_load_si512(limbs + j), g[0]);
+                g[3] = divide_limbs_avx512(_mm512_load_si512(limbs + BATCH_CHUNK + j), g[2]);
+                g[4] = _mm512_load_si512(limbs + 2 * BATCH_CHUNK + j);
+                for(int k = 0; k < 5; k++){
+                    group_chars_avx512(g[k], c[k]);
+                }
+                __m512i w0 = pack_chars_avx512(c[0][0], c[0][1], c[0][2], c[1][0]);
+                __m512i w1 = pack_chars_avx512(c[1][1], c[1][2], c[2][0], c[2][1]);
+                __m512i w2 = pack_chars_avx512(c[2][2], c[3][0], c[3][1], c[3][2]);
+                __m512i w3 = pack_chars_avx512(c[4][0], c[4][1], c[4][2], _mm512_setzero_si512());
+                __m512i a  = _mm512_unpacklo_epi32(w0, w1), b = _mm512_unpacklo_epi32(w2, w3);
+                __m512i x  = _mm512_unpackhi_epi32(w0, w1), y = _mm512_unpackhi_epi32(w2, w3);
+                __m512i s0 = _mm512_unpacklo_epi64(a, b), s1 = _mm512_unpackhi_epi64(a, b);   // s_k: serials k, k+4, k+8, k+12
+                __m512i s2 = _mm512_unpacklo_epi64(x, y), s3 = _mm512_unpackhi_epi64(x, y);
+                __m512i t0 = _mm512_shuffle_i64x2(s0, s1, 0x44), t1 = _mm512_shuffle_i64x2(s2, s3, 0x44);
+                __m512i t2 = _mm512_shuffle_i64x2(s0, s1, 0xEE), t3 = _mm512_shuffle_i64x2(s2, s3, 0xEE);
+                __m512i ln = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lens + i + j)));
+                char*   slot = out + (i + j) * TAG_BATCH_STRIDE;
+                _mm512_storeu_si512(slot,       order_tags_avx512(_mm512_shuffle_i64x2(t0, t1, 0x88), ln, 0));   // serials 0-3
+                _mm512_storeu_si512(slot + 64,  order_tags_avx512(_mm512_shuffle_i64x2(t0, t1, 0xDD), ln, 4));   // 4-7
+                _mm512_storeu_si512(slot + 128, order_tags_avx512(_mm512_shuffle_i64x2(t2, t3, 0x88), ln, 8));   // 8-11
+                _mm512_storeu_si512(slot + 192, order_tags_avx512(_mm512_shuffle_i64x2(t2, t3, 0xDD), ln, 12));  // 12-15
+            }
+            i += count;
+        }
+        encode_batch_scalar(in + i, n - i, out + i * TAG_BATCH_STRIDE, lens + i);
+    }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+}
+
+/**
+ * @brief  encode an array of serial numbers into fixed-stride tag slots
+ *
+ * Each tag is written left-aligned into its own `TAG_BATCH_STRIDE`-byte
+ * slot of `out` and padded with NULs, so every slot is also a C string.
+ * `lens[i]` receives the length of tag `i`, or 0 if `in[i]` is negative
+ * (its slot is then all NULs).  The work is vectorised with AVX-512 or AVX2
+ * where the CPU supports them (see `tag_batch_isa()`); otherwise a scalar
+ * loop over the group table is used.  All paths produce byte-identical
+ * output.
+ *
+ * @param  in   serial numbers to encode
+ * @param  n    number of serial numbers
+ * @param  out  receives `n * TAG_BATCH_STRIDE` bytes of tag slots
+ * @param  lens receives `n` tag lengths
+ */
+TAG_ENCODE_LINKAGE void tag_encode_batch(const std::int64_t* in, std::size_t n, char* out, std::uint8_t* lens) noexcept{
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+    tag_encode_detail::encode_batch_avx512(in, n, out, lens);                       // the best kernel is already targeted
+#elif TAG_ENCODE_DISPATCH
+    using kernel = void (*)(const std::int64_t*, std::size_t, char*, std::uint8_t*) noexcept;
+    static const kernel encode = tag_encode_detail::cpu() >= tag_encode_detail::cpu_level::avx512 ? tag_encode_detail::encode_batch_avx512
+                               : tag_encode_detail::cpu() >= tag_encode_detail::cpu_level::avx2   ? tag_encode_detail::encode_batch_avx2
+                               :                                                                     tag_encode_detail::encode_batch_scalar;
+    encode(in, n, out, lens);
+#elif defined(__AVX2__)
+    tag_encode_detail::encode_batch_avx2(in, n, out, lens);
+#else
+    tag_encode_detail::encode_batch_scalar(in, n, out, lens);
+#endif
+}
+#else
+TAG_ENCODE_API void tag_encode_batch(const std::int64_t* in, std::size_t n, char* out, std::uint8_t* lens) noexcept;
+#endif
+
+/**
+ * @brief  outcome of `tag_try_decode()`
+ */
+enum class tag_decode_status{
+    ok,                                                                             // tag decoded successfully
+    blank,                                                                          // tag is empty
+    bad_char,                                                                       // character not allowed at its position
+    overflow,                                                                       // value does not fit in the serial number type
+    non_canonical,                                                                  // leading zero digit (never produced by `tag_encode`)
+    bad_check                                                                       // check character does not match (a typo)
+};
+
+static_assert(static_cast<int>(tag_decode_status::bad_check) + 1 == TAG_STATS_STATUSES, "one decode counter per status");
+
+/**
+ * @brief  counters of the single-tag encoders and decoders, summed over all threads
+ *
+ * Returned by `tag_stats()`.  Encodes are the calls of `tag_encode()` and
+ * `tag_encode_checked()` (and the functions built on them); decodes are the
+ * calls of `tag_try_decode()`, `tag_try_decode_padded()`,
+ * `tag_try_decode_checked()` and so `tag_decode()`.  The batch kernels and
+ * `tag_scan()` are not counted.  Every counter only grows, as a Prometheus
+ * counter expects.  Latencies are sampled (one call in `sample_interval`)
+ * and kept as power-of-two histograms: bucket `b` counts the samples of
+ * `2^(b-1)` up to `2^b` ticks (TSC cycles on x86, nanoseconds elsewhere).
+ */
+struct tag_stats_snapshot{
+    bool          enabled         = TAG_ENCODE_STATS != 0;                          // false: compiled out, everything is zero
+    std::uint64_t sample_interval = TAG_ENCODE_STATS_SAMPLE;
+    std::uint64_t encodes         = 0;
+    std::uint64_t decodes         = 0;
+    std::uint64_t decode_status[TAG_STATS_STATUSES]  = {};                          // decodes by `tag_decode_status`; all but `ok` are failures
+    std::uint64_t encode_lengths[TAG_STATS_LENGTHS] = {};                          // tags written, by length
+    std::uint64_t decode_lengths[TAG_STATS_LENGTHS] = {};                          // tags read, by length
+    std::uint64_t encode_ticks[TAG_STATS_BUCKETS]   = {};
+    std::uint64_t decode_ticks[TAG_STATS_BUCKETS]   = {};
+    std::uint64_t encode_tick_sum = 0;                                              // sum of the sampled latencies
+    std::uint64_t decode_tick_sum = 0;
+
+    /**
+     * @brief  number of decodes that returned `status`
+     */
+    std::uint64_t decodes_by(tag_decode_status status) const noexcept{
+        return decode_status[static_cast<int>(status)];
+    }
+
+    /**
+     * @brief  number of decodes that refused their tag
+     */
+    std::uint64_t failures() const noexcept{
+        return decodes - decodes_by(tag_decode_status::ok);
+    }
+};
+
+/**
+ * @brief  aggregate the counters of every thread
+ *
+ * Each thread counts into a cache-line aligned block of its own with plain
+ * (relaxed) loads and stores, so counting never contends; this function
+ * locks only the list of blocks and sums them, plus the totals of threads
+ * that have exited.  Cheap enough to call on every metrics scrape.  With
+ * `TAG_ENCODE_STATS` left at 0 it returns a snapshot with `enabled` false.
+ *
+ * @return  the counters at the time of the call
+ */
+inline tag_stats_snapshot tag_stats(){
+    tag_stats_snapshot snapshot;
+#if TAG_ENCODE_STATS
+    using namespace tag_encode_detail;
+    stats_counters  total{};
+    stats_registry& registry = stats_shards();
+    {
+        std::lock_guard<std::mutex> guard(registry.lock);
+        stats_fold(registry.retired, total);
+        for(const stats_shard* shard : registry.live){
+            stats_fold(*shard, total);
+        }
+    }
+    auto read = [](const std::atomic<std::uint64_t>* from, std::uint64_t* to, int n){
+        for(int i = 0; i < n; i++){
+            to[i] = from[i].load(std::memory_order_relaxed);
+        }
+    };
+    read(&total.calls[stats_encode], &snapshot.encodes, 1);
+    read(&total.calls[stats_decode], &snapshot.decodes, 1);
+    read(total.status, snapshot.decode_status, TAG_STATS_STATUSES);
+    read(total.lengths[stats_encode], snapshot.encode_lengths, TAG_STATS_LENGTHS);
+    read(total.lengths[stats_decode], snapshot.decode_lengths, TAG_STATS_LENGTHS);
+    read(total.ticks[stats_encode], snapshot.encode_ticks, TAG_STATS_BUCKETS);
+    read(total.ticks[stats_decode], snapshot.decode_ticks, TAG_STATS_BUCKETS);
+    read(&total.tick_sum[stats_encode], &snapshot.encode_tick_sum, 1);
+    read(&total.tick_sum[stats_decode], &snapshot.decode_tick_sum, 1);
+#endif
+    return snapshot;
+}
+
+namespace tag_encode_detail{
+    /**
+     * @brief  shared decoder of `tag_try_decode()` and `tag_try_decode_padded()`
+     *
+     * @param  canonical    refuse a leading zero digit, as `tag_encode()` never writes one
+     */
+    constexpr tag_decode_status decode_tag(std::string_view tag, long int& serial, bool canonical) noexcept{
+        if(tag.size() < 1){
+            return tag_decode_status::blank;
+        }
+        int                digit    = 0;
+        unsigned long long value    = 0;                                            // cannot wrap within TAG_MAX_LENGTH characters
+        std::size_t        tag_size = tag.size();
+        int                k        = (tag_size - 1) % 3;                           // position class of the leading character
+
+        for(std::size_t i = 0; i < tag_size; i++, k = (k == 0) ? 2 : k - 1){       // most-significant character first
+            digit = DIGITS.value[k][static_cast<unsigned char>(tag[i])];
+            if(digit == INVALID_DIGIT){
+                return tag_decode_status::bad_char;                                 // wrong character class for this position
+            }
+            if(canonical && i == 0 && digit == 0 && tag_size > 1){                  // leading zero digit: tag_encode()
+                return tag_decode_status::non_canonical;                            // would never produce it
+            }
+            value = value * BASE_SELECT[k] + digit;
+        }
+        if(tag_size > static_cast<std::size_t>(TAG_MAX_LENGTH) ||
+           value > static_cast<unsigned long long>(std::numeric_limits<long int>::max())){
+            return tag_decode_status::overflow;                                     // does not fit in a 'long int'
+        }
+        serial = value;
+        return tag_decode_status::ok;
+    }
+}
+
+/**
+ * @brief  decode a tag without throwing or copying the input
+ *
+ * Non-throwing form of `tag_decode()` that reports why a tag was refused.
+ * The tag is read in place; upper-case letters and the often-mistaken
+ * digits '0' and '1' are accepted exactly as `tag_decode()` accepts them.
+ * Each character costs one lookup in a 256-entry table for its position
+ * class, so decoding does not depend on the process locale.  Usable in
+ * constant expressions; see also the `_tag` literal.
+ *
+ * @param  tag      "tag" string as produced by the `tag_encode` function
+ * @param  serial   receives the decoded serial number; left unchanged unless
+ *                  the result is `tag_decode_status::ok`
+ * @return          `tag_decode_status::ok` or the reason the tag is invalid
+ */
+constexpr tag_decode_status tag_try_decode(std::string_view tag, long int& serial) noexcept{
+    TAG_ENCODE_STATS_BEGIN(decode);
+    tag_decode_status status = tag_encode_detail::decode_tag(tag, serial, true);
+    TAG_ENCODE_STATS_END(decode, tag.size(), static_cast<int>(status));
+    return status;
+}
+
+/**
+ * @brief  decode a tag without throwing or copying the input
+ *
+ * @see    tag_try_decode(std::string_view, long int&)
+ *
+ * @param  tag "tag" string as produced by the `tag_encode` function
+ * @return     the serial number, or an empty optional if the tag is invalid
+ */
+constexpr std::optional<long int> tag_try_decode(std::string_view tag) noexcept{
+    long int serial = 0;
+    if(tag_try_decode(tag, serial) != tag_decode_status::ok){
+        return std::nullopt;
+    }
+    return serial;
+}
+
+/**
+ * @brief  decode a fixed-width tag written by `tag_encode_padded()`
+ *
+ * Accepts everything `tag_try_decode()` accepts, plus tags with leading zero
+ * digits, so a tag decodes the same at any padded width: "a22a22a2" (the
+ * serial 0 at width 8), "a2" and "2" all decode to 0.
+ *
+ * @param  tag      padded or unpadded tag, at most `TAG_MAX_LENGTH` characters
+ * @param  serial   receives the decoded serial number; left unchanged unless
+ *                  the result is `tag_decode_status::ok`
+ * @return          `tag_decode_status::ok` or the reason the tag is invalid
+ *                  (never `tag_decode_status::non_canonical`)
+ */
+constexpr tag_decode_status tag_try_decode_padded(std::string_view tag, long int& serial) noexcept{
+    TAG_ENCODE_STATS_BEGIN(decode);
+    tag_decode_status status = tag_encode_detail::decode_tag(tag, serial, false);
+    TAG_ENCODE_STATS_END(decode, tag.size(), static_cast<int>(status));
+    return status;
+}
+
+/**
+ * @brief  decode a fixed-width tag written by `tag_encode_padded()`
+ *
+ * @see    tag_try_decode_padded(std::string_view, long int&)
+ *
+ * @param  tag padded or unpadded tag
+ * @return     the serial number, or an empty optional if the tag is invalid
+ */
+constexpr std::optional<long int> tag_try_decode_padded(std::string_view tag) noexcept{
+    long int serial = 0;
+    if(tag_try_decode_padded(tag, serial) != tag_decode_status::ok){
+        return std::nullopt;
+    }
+    return serial;
+}
+
+namespace tag_encode_detail{
+    /**
+     * @brief  for each tag length, the bytes of the 16-byte window where a digit or a letter may appear
+     *
+     * Byte `i` of the window is character `i` of the tag, and holds 0x80
+     * in `digit` if the character's position class admits '2'-'9', and in
+     * `letter` if it admits a letter (or '0'/'1', read as 'o'/'l').  Bytes
+     * past the end of the tag are clear in both.
+     */
+    struct plausible_table{
+        std::uint64_t digit[TAG_MAX_LENGTH + 1][2];
+        std::uint64_t letter[TAG_MAX_LENGTH + 1][2];
+    };
+
+    constexpr plausible_table make_plausible_table(){
+        plausible_table table{};
+        for(int length = 1; length <= TAG_MAX_LENGTH; length++){
+            for(int i = 0; i < length; i++){
+                int           k   = (length - 1 - i) % 3;
+                std::uint64_t bit = std::uint64_t(0x80) << (8 * (i % 8));
+                if(BASE_SELECT[k] != N_ALPHACASE){
+                    table.digit[length][i / 8] |= bit;
+                }
+                if(BASE_SELECT[k] != N_DIGITS){
+                    table.letter[length][i / 8] |= bit;
+                }
+            }
+        }
+        return table;
+    }
+
+    inline constexpr plausible_table PLAUSIBLE = make_plausible_table();
+
+    /**
+     * @brief  `count` bytes as a little-endian word (a single load on x86 and ARM)
+     */
+    constexpr std::uint64_t load_le(const char* bytes, int count){
+        std::uint64_t word = 0;
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if(!__builtin_is_constant_evaluated()){
+            std::memcpy(&word, bytes, count);
+            return word;
+        }
+#endif
+        for(int j = 0; j < count; j++){
+            word |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[j])) << (8 * j);
+        }
+        return word;
+    }
+
+    /**
+     * @brief  the first `size` (1 to 15) bytes of `tag` as two words, without reading past them
+     *
+     * Overlapping loads anchored at both ends of the tag cover every length
+     * without a byte loop or a copy through memory.
+     */
+    constexpr void load_window(const char* tag, std::size_t size, std::uint64_t& low, std::uint64_t& high){
+        if(size >= 8){
+            low  = load_le(tag, 8);
+            high = load_le(tag + size - 8, 8) >> (8 * (15 - size)) >> 8;           // bytes 8 to size - 1
+        }else if(size >= 4){
+            low  = load_le(tag, 4) | load_le(tag + size - 4, 4) << (8 * (size - 4));
+            high = 0;
+        }else{
+            low  = load_le(tag, 1) | load_le(tag + size / 2, 1) << (8 * (size / 2)) | load_le(tag + size - 1, 1) << (8 * (size - 1));
+            high = 0;
+        }
+    }
+
+    /**
+     * @brief  0x80 in every byte of `word` that lies in `[lo, hi]`, for bytes below 0x80
+     */
+    constexpr std::uint64_t bytes_in_range(std::uint64_t word, unsigned char lo, unsigned char hi){
+        constexpr std::uint64_t ones = 0x0101010101010101ULL;
+        std::uint64_t           at_least = word + ones * (0x80 - lo);               // no carry between bytes below 0x80
+        std::uint64_t           above    = word + ones * (0x7F - hi);
+        return at_least & ~above & ones * 0x80;
+    }
+
+    /**
+     * @brief  0x80 in every byte of `word` whose character may not stand where the masks put it
+     */
+    constexpr std::uint64_t misplaced(std::uint64_t word, std::uint64_t digit_at, std::uint64_t letter_at){
+        constexpr std::uint64_t high    = 0x8080808080808080ULL;
+        std::uint64_t           ascii   = ~word & high;                             // bytes from 0x80 up are never tag characters
+        std::uint64_t           low     = word & ~high;
+        std::uint64_t           digits  = bytes_in_range(low, '2', '9') & ascii;
+        std::uint64_t           letters = (bytes_in_range(low | 0x2020202020202020ULL, 'a', 'z') | bytes_in_range(low, '0', '1')) & ascii;
+        return ((digits & digit_at) | (letters & letter_at)) ^ (digit_at | letter_at);
+    }
+}
+
+/**
+ * @brief  cheap pre-filter: could `tag` be a tag at all?
+ *
+ * Checks the length (1 to `TAG_MAX_LENGTH`) and that every character
+ * belongs to the class of its position -- a digit '2'-'9', a letter (either
+ * case, or '0'/'1'), or either -- without computing the value.  The tag is
+ * read with overlapping loads into a 16-byte window, classified with a few
+ * SSE2 compares (word-wide adds and masks elsewhere and in constant
+ * expressions), and compared against precomputed masks for its length.
+ *
+ * Every tag that `tag_encode()` produces, and every string that
+ * `tag_try_decode()` accepts, is plausible.  The converse does not hold:
+ * a plausible string may still have a leading zero digit or exceed
+ * `LONG_MAX`, so decode it before use.
+ *
+ * @param  tag  characters of the candidate; need not be NUL-terminated
+ * @param  size number of characters
+ * @return      false if the string cannot be a tag
+ */
+constexpr bool tag_is_plausible(const char* tag, std::size_t size) noexcept{
+    using namespace tag_encode_detail;
+    if(size - 1 >= static_cast<std::size_t>(TAG_MAX_LENGTH)){                       // also catches 0
+        return false;
+    }
+    std::uint64_t low = 0, high = 0;
+    load_window(tag, size, low, high);
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+    if(!__builtin_is_constant_evaluated()){
+        __m128i chars   = _mm_set_epi64x(high, low);                                // signed compares: bytes from 0x80 up fail
+        __m128i folded  = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        __m128i digits  = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('1')), _mm_cmplt_epi8(chars, _mm_set1_epi8(':')));
+        __m128i letters = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('`')), _mm_cmplt_epi8(folded, _mm_set1_epi8('{'))),
+                                       _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('0')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('1'))));
+        __m128i digit_at  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(PLAUSIBLE.digit[size]));
+        __m128i letter_at = _mm_loadu_si128(reinterpret_cast<const __m128i*>(PLAUSIBLE.letter[size]));
+        __m128i allowed   = _mm_or_si128(_mm_and_si128(digits, digit_at), _mm_and_si128(letters, letter_at));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(allowed, _mm_or_si128(digit_at, letter_at))) == 0xFFFF;
+    }
+#endif
+    return (misplaced(low, PLAUSIBLE.digit[size][0], PLAUSIBLE.letter[size][0]) |
+            misplaced(high, PLAUSIBLE.digit[size][1], PLAUSIBLE.letter[size][1])) == 0;
+}
+
+/**
+ * @brief  cheap pre-filter: could `tag` be a tag at all?
+ *
+ * @see    tag_is_plausible(const char*, std::size_t)
+ */
+constexpr bool tag_is_plausible(std::string_view tag) noexcept{
+    return tag_is_plausible(tag.data(), tag.size());
+}
+
+#if TAG_ENCODE_COMPILE_BATCH
+namespace tag_encode_detail{
+    /**
+     * @brief  length of the NUL-padded tag in a `TAG_BATCH_STRIDE`-byte slot
+     */
+    inline std::size_t slot_length(const char* slot) noexcept{
+        const void* nul = std::memchr(slot, 0, TAG_BATCH_STRIDE);
+        return nul ? static_cast<const char*>(nul) - slot : TAG_BATCH_STRIDE;
+    }
+
+    /**
+     * @brief  record one decode result in the output array and validity bitmap
+     */
+    inline void store_decoded(std::size_t i, bool ok, long int serial, std::int64_t* out, std::uint8_t* valid) noexcept{
+        if(i % 8 == 0){
+            valid[i / 8] = 0;
+        }
+        valid[i / 8] |= ok << (i % 8);
+        out[i]        = ok ? serial : 0;
+    }
+
+    /**
+     * @brief  scalar batch decoder over fixed-stride slots; the reference for the SIMD kernel
+     */
+    inline void decode_batch_scalar(const char* in, std::size_t n, std::int64_t* out, std::uint8_t* valid) noexcept{
+        for(std::size_t i = 0; i < n; i++){
+            const char* slot   = in + i * TAG_BATCH_STRIDE;
+            long int    serial = 0;
+            bool        ok     = decode_tag(std::string_view(slot, slot_length(slot)), serial, true) == tag_decode_status::ok;
+            store_decoded(i, ok, serial, out, valid);
+        }
+    }
+
+#if TAG_ENCODE_SSSE3
+    /**
+     * @brief  decode one tag held in the first `length` bytes of a vector
+     *
+     * The characters are reversed so that byte `p` holds position `p` (least
+     * significant first), classified and folded in-register against the
+     * repeating (34, 26, 8) class pattern, and combined into base-7072 groups
+     * with two multiply-add steps.  Accepts exactly the tags `tag_try_decode`
+     * accepts.
+     */
+    TAG_ENCODE_TARGET("ssse3") inline bool decode_tag_ssse3(__m128i tag, std::size_t length, long int& serial) noexcept{
+        const __m128i position = _mm_setr_epi8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+        const __m128i alpha_at = _mm_setr_epi8(0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0);   // radix-26 positions
+        const __m128i digit_at = _mm_setr_epi8(0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0);   // radix-8 positions
+        if(length < 1 || length > static_cast<std::size_t>(TAG_MAX_LENGTH)){
+            return false;
+        }
+        __m128i len    = _mm_set1_epi8(length);
+        __m128i inside = _mm_cmpgt_epi8(len, _mm_sub_epi8(position, _mm_set1_epi8(1)));
+        __m128i c      = _mm_shuffle_epi8(tag, _mm_sub_epi8(len, position));       // byte p = position p; NULs beyond the tag
+        c = _mm_add_epi8(c, _mm_and_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('0')), _mm_set1_epi8('o' - '0')));   // "user-proof" 0's as o's
+        c = _mm_add_epi8(c, _mm_and_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('1')), _mm_set1_epi8('l' - '1')));   // and 1's as l's
+        __m128i upper  = _mm_sub_epi8(c, _mm_set1_epi8('A'));
+        c = _mm_or_si128(c, _mm_and_si128(_mm_cmpeq_epi8(_mm_min_epu8(upper, _mm_set1_epi8(25)), upper), _mm_set1_epi8(0x20)));
+        __m128i letter = _mm_sub_epi8(c, _mm_set1_epi8('a'));
+        __m128i digit  = _mm_sub_epi8(c, _mm_set1_epi8('2'));
+        __m128i is_let = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(N_ALPHACASE - 1)), letter);
+        __m128i is_dig = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(N_DIGITS - 1)), digit);
+        __m128i allow  = _mm_or_si128(_mm_andnot_si128(alpha_at, is_dig), _mm_andnot_si128(digit_at, is_let));
+        if(_mm_movemask_epi8(_mm_andnot_si128(allow, inside)) != 0){
+            return false;                                                           // wrong character class for a position
+        }
+        __m128i radix34 = _mm_andnot_si128(_mm_or_si128(alpha_at, digit_at), _mm_set1_epi8(N_DIGITS));
+        __m128i value   = _mm_or_si128(_mm_and_si128(is_dig, digit), _mm_andnot_si128(is_dig, _mm_add_epi8(letter, radix34)));
+        value = _mm_and_si128(value, inside);
+        if(length > 1 && (_mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_setzero_si128())) >> (length - 1) & 1)){
+            return false;                                                           // leading zero digit
+        }
+        const __m128i pair = _mm_setr_epi8(1, N_ALPHANUM, 1, 0, 1, N_ALPHANUM, 1, 0, 1, N_ALPHANUM, 1, 0, 1, N_ALPHANUM, 1, 0);
+        const __m128i join = _mm_setr_epi16(1, N_ALPHANUM * N_ALPHACASE, 1, N_ALPHANUM * N_ALPHACASE,
+                                            1, N_ALPHANUM * N_ALPHACASE, 1, N_ALPHANUM * N_ALPHACASE);
+        __m128i low   = _mm_shuffle_epi8(value, _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+        __m128i high  = _mm_shuffle_epi8(value, _mm_setr_epi8(12, 13, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+        __m128i group = _mm_madd_epi16(_mm_maddubs_epi16(low, pair), join);        // groups 0-3 as 32-bit lanes
+        __m128i top   = _mm_madd_epi16(_mm_maddubs_epi16(high, pair), join);       // group 4
+        __m128i limbs = _mm_madd_epi16(_mm_packs_epi32(group, group), _mm_setr_epi16(1, GROUP_BASE, 1, GROUP_BASE, 0, 0, 0, 0));
+        std::uint64_t both  = _mm_cvtsi128_si64(limbs);
+        std::uint64_t total = (both & 0xFFFFFFFF) + (both >> 32) * LIMB_BASE
+                            + static_cast<std::uint64_t>(_mm_cvtsi128_si32(top)) * LIMB_BASE * LIMB_BASE;
+        if(total > static_cast<std::uint64_t>(std::numeric_limits<long int>::max())){
+            return false;                                                           // does not fit in a 'long int'
+        }
+        serial = total;
+        return true;
+    }
+
+    /**
+     * @brief  SSSE3 batch decoder over fixed-stride slots: one tag per vector
+     */
+    TAG_ENCODE_TARGET("ssse3") inline void decode_batch_ssse3(const char* in, std::size_t n, std::int64_t* out, std::uint8_t* valid) noexcept{
+        for(std::size_t i = 0; i < n; i++){
+            __m128i   slot   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * TAG_BATCH_STRIDE));
+            unsigned  nuls   = _mm_movemask_epi8(_mm_cmpeq_epi8(slot, _mm_setzero_si128())) | 0x10000;
+            long int  serial = 0;
+            bool      ok     = decode_tag_ssse3(slot, __builtin_ctz(nuls), serial);
+            store_decoded(i, ok, serial, out, valid);
+        }
+    }
+
+    /**
+     * @brief  SSSE3 batch decoder over offset-indexed tags
+     */
+    TAG_ENCODE_TARGET("ssse3") inline void decode_offsets_ssse3(const char* data, const std::int32_t* offsets, std::size_t n,
+                                                                std::int64_t* out, std::uint8_t* valid) noexcept{
+        for(std::size_t i = 0; i < n; i++){
+            std::size_t length = offsets[i + 1] - offsets[i];
+            long int    serial = 0;
+            bool        ok;
+            if(offsets[i] + TAG_BATCH_STRIDE <= static_cast<std::size_t>(offsets[n])){  // 16 readable bytes: load in place
+                ok = decode_tag_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offsets[i])), length, serial);
+            }
+            else{
+                char slot[TAG_BATCH_STRIDE] = {};
+                std::memcpy(slot, data + offsets[i], std::min(length, TAG_BATCH_STRIDE));
+                ok = decode_tag_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(slot)), length, serial);
+            }
+            store_decoded(i, ok, serial, out, valid);
+        }
+    }
+#endif
+
+    /**
+     * @brief  scalar batch decoder over offset-indexed tags
+     */
+    inline void decode_offsets_scalar(const char* data, const std::int32_t* offsets, std::size_t n,
+                                      std::int64_t* out, std::uint8_t* valid) noexcept{
+        for(std::size_t i = 0; i < n; i++){
+            long int serial = 0;
+            bool     ok     = decode_tag(std::string_view(data + offsets[i], offsets[i + 1] - offsets[i]), serial, true) == tag_decode_status::ok;
+            store_decoded(i, ok, serial, out, valid);
+        }
+    }
+
+    /**
+     * @brief  true if the SSSE3 decoders can run
+     */
+    inline bool use_ssse3() noexcept{
+#if defined(__SSSE3__)
+        return true;
+#elif TAG_ENCODE_DISPATCH
+        return cpu() >= cpu_level::ssse3;
+#else
+        return false;
+#endif
+    }
+}
+
+/**
+ * @brief  decode an array of fixed-stride tag slots
+ *
+ * Reads `n` tags laid out as `tag_encode_batch()` writes them: one per
+ * `TAG_BATCH_STRIDE`-byte slot, ending at the first NUL or the end of the
+ * slot.  Invalid tags do not stop the batch: bit `i % 8` of `valid[i / 8]`
+ * is set only if tag `i` is one `tag_try_decode` accepts, and `out[i]` is 0
+ * otherwise.  Where the CPU has SSSE3 the characters are classified,
+ * case-folded and accumulated in-register, one tag per vector.
+ *
+ * @param  in    `n * TAG_BATCH_STRIDE` bytes of tag slots
+ * @param  n     number of tags
+ * @param  out   receives `n` serial numbers
+ * @param  valid receives a validity bitmap of `(n + 7) / 8` bytes (least-significant bit first)
+ */
+TAG_ENCODE_LINKAGE void tag_decode_batch(const char* in, std::size_t n, std::int64_t* out, std::uint8_t* valid) noexcept{
+#if TAG_ENCODE_SSSE3
+    if(tag_encode_detail::use_ssse3()){
+        tag_encode_detail::decode_batch_ssse3(in, n, out, valid);
+        return;
+    }
+#endif
+    tag_encode_detail::decode_batch_scalar(in, n, out, valid);
+}
+
+/**
+ * @brief  decode an array of offset-indexed tags
+ *
+ * Tag `i` occupies bytes `[offsets[i], offsets[i + 1])` of `data`, as in an
+ * Arrow string column.  Results are reported as for the fixed-stride form.
+ *
+ * @param  data    concatenated tag characters
+ * @param  offsets `n + 1` offsets into `data`
+ * @param  n       number of tags
+ * @param  out     receives `n` serial numbers
+ * @param  valid   receives a validity bitmap of `(n + 7) / 8` bytes (least-significant bit first)
+ */
+TAG_ENCODE_LINKAGE void tag_decode_batch(const char* data, const std::int32_t* offsets, std::size_t n, std::int64_t* out, std::uint8_t* valid) noexcept{
+#if TAG_ENCODE_SSSE3
+    if(tag_encode_detail::use_ssse3()){
+        tag_encode_detail::decode_offsets_ssse3(data, offsets, n, out, valid);
+        return;
+    }
+#endif
+    tag_encode_detail::decode_offsets_scalar(data, offsets, n, out, valid);
+}
+#else
+TAG_ENCODE_API void tag_decode_batch(const char* in, std::size_t n, std::int64_t* out, std::uint8_t* valid) noexcept;
+TAG_ENCODE_API void tag_decode_batch(const char* data, const std::int32_t* offsets, std::size_t n, std::int64_t* out, std::uint8_t* valid) noexcept;
+#endif
+
+#if TAG_ENCODE_COMPILE_BATCH
+namespace tag_encode_detail{
+    /**
+     * @brief  bit `i` of `masks[b]` is set if byte `64 * b + i` of `data` is a letter or digit
+     */
+    inline void classify_scalar(const char* data, std::size_t blocks, std::uint64_t* masks) noexcept{
+        for(std::size_t b = 0; b < blocks; b++){
+            std::uint64_t mask = 0;
+            for(int i = 0; i < 64; i++){                                            // class 0 accepts every letter and digit
+                mask |= static_cast<std::uint64_t>(DIGITS.value[0][static_cast<unsigned char>(data[64 * b + i])] != INVALID_DIGIT) << i;
+            }
+            masks[b] = mask;
+        }
+    }
+
+#if TAG_ENCODE_AVX2
+    /**
+     * @brief  letters and digits among 32 bytes: biased signed compares stand in for unsigned range checks
+     */
+    TAG_ENCODE_TARGET("avx2") inline std::uint32_t classify_avx2_32(const char* data) noexcept{
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));           // 'A'-'Z' -> 'a'-'z'
+        __m256i alpha = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26), _mm256_add_epi8(lower, _mm256_set1_epi8(static_cast<char>(128 - 'a'))));
+        __m256i digit = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 10), _mm256_add_epi8(chars, _mm256_set1_epi8(static_cast<char>(128 - '0'))));
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(alpha, digit)));
+    }
+
+    TAG_ENCODE_TARGET("avx2") inline void classify_avx2(const char* data, std::size_t blocks, std::uint64_t* masks) noexcept{
+        for(std::size_t b = 0; b < blocks; b++){
+            masks[b] = classify_avx2_32(data + 64 * b) | static_cast<std::uint64_t>(classify_avx2_32(data + 64 * b + 32)) << 32;
+        }
+    }
+#endif
+
+#if TAG_ENCODE_AVX512
+    TAG_ENCODE_TARGET("avx512f,avx512bw") inline void classify_avx512(const char* data, std::size_t blocks, std::uint64_t* masks) noexcept{
+        for(std::size_t b = 0; b < blocks; b++){
+            __m512i chars = _mm512_loadu_si512(data + 64 * b);
+            __m512i lower = _mm512_or_si512(chars, _mm512_set1_epi8(0x20));
+            masks[b] = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(lower, _mm512_set1_epi8('a')), _mm512_set1_epi8(26)) |
+                       _mm512_cmplt_epu8_mask(_mm512_sub_epi8(chars, _mm512_set1_epi8('0')), _mm512_set1_epi8(10));
+        }
+    }
+#endif
+
+    /**
+     * @brief  letter-or-digit bitmasks of `blocks` 64-byte blocks, with the best kernel for the CPU
+     */
+    TAG_ENCODE_LINKAGE void classify_tag_chars(const char* data, std::size_t blocks, std::uint64_t* masks) noexcept{
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+        classify_avx512(data, blocks, masks);
+#elif TAG_ENCODE_DISPATCH
+        using kernel = void (*)(const char*, std::size_t, std::uint64_t*) noexcept;
+        static const kernel classify = cpu() >= cpu_level::avx512 ? classify_avx512
+                                     : cpu() >= cpu_level::avx2   ? classify_avx2
+                                     :                              classify_scalar;
+        classify(data, blocks, masks);
+#elif defined(__AVX2__)
+        classify_avx2(data, blocks, masks);
+#else
+        classify_scalar(data, blocks, masks);
+#endif
+    }
+}
+#else
+namespace tag_encode_detail{
+    TAG_ENCODE_API void classify_tag_chars(const char* data, std::size_t blocks, std::uint64_t* masks) noexcept;
+}
+#endif
+
+/**
+ * @brief  a tag found by `tag_scanner` or `tag_scan()`
+ */
+struct tag_match{
+    std::size_t offset;                                                             // position of the first character in the input
+    std::size_t length;                                                             // number of characters
+    long int    serial;                                                             // decoded serial number
+};
+
+/**
+ * @brief  find and decode the tags embedded in text, a buffer at a time
+ *
+ * A candidate is a maximal run of letters and digits (so tags are found
+ * between any punctuation, whitespace or URL delimiters) of `min_length` to
+ * `TAG_MAX_LENGTH` characters; it is reported if `tag_try_decode()` accepts
+ * it, so ordinary words fail the alternating class pattern and never throw.
+ * The input is classified 64 bytes at a time with AVX-512 or AVX2 where
+ * available, and the runs are read off the resulting bitmasks, so the cost
+ * is dominated by the candidates rather than the bytes.  Nothing is copied
+ * except a candidate that straddles two `feed()` calls.
+ *
+ * @remark  Every short letter-digit word is some tag ("a2" is the serial
+ *          34), so `min_length` (4 by default) is the main guard against
+ *          false positives in prose.
+ */
+class tag_scanner{
+public:
+    static constexpr std::size_t CLASSIFY_BLOCKS = 64;                              // 4 KiB of input per call to the kernel
+
+    /**
+     * @param  min_length shortest run that is reported (at least 1)
+     */
+    explicit tag_scanner(std::size_t min_length = 4) noexcept :
+        carry{}, shortest(std::max<std::size_t>(min_length, 1)){}
+
+    /**
+     * @brief  scan the next part of the input
+     *
+     * `visit` is called with a `tag_match` for each tag that ends in this
+     * part, in input order; offsets count from the start of the stream.  A
+     * run still open at the end of `data` is reported by a later `feed()` or
+     * by `finish()`.
+     */
+    template<typename Visitor>
+    void feed(const char* data, std::size_t size, Visitor&& visit){
+        std::uint64_t masks[CLASSIFY_BLOCKS];
+        bool          carried = inside;                                             // the open run began in an earlier part
+        std::size_t   start   = 0;
+        for(std::size_t base = 0; base < size; base += 64 * CLASSIFY_BLOCKS){
+            std::size_t span   = std::min<std::size_t>(size - base, 64 * CLASSIFY_BLOCKS);
+            std::size_t blocks = span / 64;
+            tag_encode_detail::classify_tag_chars(data + base, blocks, masks);
+            if(span % 64 != 0){
+                char tail[64] = {};                                                 // NUL is not a tag character
+                std::memcpy(tail, data + base + 64 * blocks, span % 64);
+                tag_encode_detail::classify_tag_chars(tail, 1, masks + blocks++);
+            }
+            for(std::size_t b = 0; b < blocks; b++){
+                std::uint64_t mask  = masks[b];
+                std::uint64_t edges = mask ^ ((mask << 1) | (inside ? 1 : 0));      // bytes where a run starts or ends
+                if(span - 64 * b < 64){
+                    edges &= (std::uint64_t(1) << (span - 64 * b)) - 1;
+                }
+                for(; edges != 0; edges &= edges - 1){
+                    std::size_t position = base + 64 * b + count_trailing_zeros(edges);
+                    inside = !inside;
+                    if(inside){
+                        start = position;
+                    }else if(carried){
+                        close_carried(data, position, visit);
+                        carried = false;
+                    }else{
+                        report(data + start, position - start, consumed + start, visit);
+                    }
+                }
+            }
+        }
+        if(inside){                                                                 // keep the open run for the next part
+            std::size_t from = carried ? 0 : start, length = size - from;
+            if(!carried){
+                pending = 0;
+            }
+            if(pending + length <= static_cast<std::size_t>(TAG_MAX_LENGTH)){
+                std::memcpy(carry + pending, data + from, length);
+            }
+            pending += length;
+        }
+        consumed += size;
+    }
+
+    /**
+     * @brief  end the stream: report a tag left open at its end, then start over at offset 0
+     */
+    template<typename Visitor>
+    void finish(Visitor&& visit){
+        if(inside && pending <= static_cast<std::size_t>(TAG_MAX_LENGTH)){
+            report(carry, pending, consumed - pending, visit);
+        }
+        inside   = false;
+        pending  = 0;
+        consumed = 0;
+    }
+
+    /**
+     * @brief  number of bytes fed since the stream began
+     */
+    std::size_t position() const noexcept{
+        return consumed;
+    }
+
+private:
+    static int count_trailing_zeros(std::uint64_t bits) noexcept{
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(bits);
+#else
+        int count = 0;
+        for(; (bits & 1) == 0; bits >>= 1){
+            count++;
+        }
+        return count;
+#endif
+    }
+
+    template<typename Visitor>
+    void report(const char* chars, std::size_t length, std::size_t offset, Visitor& visit) const{
+        long int serial = 0;
+        if(length >= shortest && length <= static_cast<std::size_t>(TAG_MAX_LENGTH) &&
+           tag_encode_detail::decode_tag(std::string_view(chars, length), serial, true) == tag_decode_status::ok){
+            visit(tag_match{offset, length, serial});
+        }
+    }
+
+    /**
+     * @brief  end a run whose first `pending` characters came from earlier parts
+     */
+    template<typename Visitor>
+    void close_carried(const char* data, std::size_t end, Visitor& visit){
+        if(pending + end <= static_cast<std::size_t>(TAG_MAX_LENGTH)){
+            char joined[TAG_MAX_LENGTH];
+            std::memcpy(joined, carry, pending);
+            std::memcpy(joined + pending, data, end);
+            report(joined, pending + end, consumed - pending, visit);
+        }
+        pending = 0;
+    }
+
+    char        carry[TAG_MAX_LENGTH];                                              // open run, if short enough to be a tag
+    std::size_t pending  = 0;                                                       // characters of the open run before this part
+    std::size_t consumed = 0;
+    std::size_t shortest;
+    bool        inside   = false;                                                   // the last byte fed was a letter or digit
+};
+
+/**
+ * @brief  find and decode every tag in one buffer (or memory-mapped file)
+ *
+ * @see    tag_scanner
+ *
+ * @param  data       text to scan
+ * @param  size       size of `data` in bytes
+ * @param  visit      called with a `tag_match` for each tag, in order
+ * @param  min_length shortest run that is reported
+ * @return            number of tags found
+ */
+template<typename Visitor>
+std::size_t tag_scan(const char* data, std::size_t size, Visitor&& visit, std::size_t min_length = 4){
+    std::size_t found = 0;
+    tag_scanner scanner(min_length);
+    auto        count = [&](const tag_match& match){
+        found++;
+        visit(match);
+    };
+    scanner.feed(data, size, count);
+    scanner.finish(count);
+    return found;
+}
+
+namespace tag_encode_detail{
+    /**
+     * @brief  throw the `std::invalid_argument` that the decoders report for a refused tag
+     */
+    [[noreturn]] inline void throw_invalid_tag(std::string_view tag, tag_decode_status status){
+        if(status == tag_decode_status::blank){
+            throw std::invalid_argument("Tag cannot be blank.");
+        }
+        if(status == tag_decode_status::bad_check){
+            throw std::invalid_argument(std::string("Tag check character does not match: \"") + std::string(tag) + "\"");
+        }
+        std::string normalized(tag);                                                // Any kind of mismatch creates an exception
+        for(char& c : normalized){
+            c = fold_char(c);
+        }
+        throw std::invalid_argument(
+            std::string("Invalid input tag: \"") + normalized + "\""
+        );
+    }
+}
+
+/**
+ * @brief  decode an alphanumeric "tag" string into its corresponding integer
+ * 
+ * Decode a "tag" produced by the `tag_encode` function into its corresponding
+ * non-negative integer.  For robustness, this function will accept upper- and
+ * lower-case versions of the tag string, and converts often-mistaken characters
+ * '0' and '1' into 'O' and 'l' on-the-fly.  Use `tag_try_decode()` where
+ * invalid tags are expected and exceptions are too costly.
+ *
+ * @remark  The tag encoding is web-safe, using only the characters
+ *          a-z2-9.  The digits '0' and '1' are NOT used, since they are easily
+ *          visually confused with the characters 'O' and 'l'.  Tags are not case-
+ *          sensitive, but are always generated with lowercase characters.
+ *          Additionally, this scheme always guarentees that there is are never more
+ *          than two consecutive alphabetical characters, thereby avoiding the need
+ *          to blacklist any "impolite" words.  Also, there are never more than two
+ *          consecutive numbers, avoiding "big number" appearance.
+ *          These tags are shorter than the serial numbers produced:
+ *          (MAX_INT  of          2147483646 encodes as ba9n82dq        -- 8 characters!)
+ *          (Max long of 9223372036854775806 encodes as 6eh5g28yq5mi7bq -- 15 characters!)
+ *
+ * @throw  std::invalid_argument    thrown if the tag is blank, contains a character
+ *                                  not allowed at its position, has a leading zero
+ *                                  digit, or does not fit in a 'long int' -- that is,
+ *                                  if the tag is not one `tag_encode` would produce
+ * 
+ * @param  tag "tag" string as produced by the `tag_encode` function
+ * @return     non-negative integer serial number corresponding to the input tag
+ */
+inline long int tag_decode(std::string_view tag){
+    long int          serial = 0;
+    tag_decode_status status = tag_try_decode(tag, serial);
+    if(status != tag_decode_status::ok){
+        tag_encode_detail::throw_invalid_tag(tag, status);
+    }
+    return serial;                                                                  // return only if all is well
+}
+
+/**
+ * @brief  a tag held by value in 16 bytes: up to `TAG_MAX_LENGTH` characters and their count
+ *
+ * A compact key for caches and hash maps in place of `std::string`.  The
+ * tag is stored zero-padded to the full width, as `tag_encode_padded()`
+ * writes it, in the first 15 bytes and its length in the last, so the type
+ * is trivially copyable, needs no allocation, and two values compare equal
+ * exactly when their 16 bytes do (two 8-byte compares, or one SSE compare).
+ * Every non-empty value holds the canonical tag written by `tag_encode()`:
+ * a tag given as a string is decoded and re-encoded, so "BA9N82DQ" and
+ * "ba9n82dq" are the same value.  A default-constructed value is empty (all
+ * zero bytes) and is not a tag.
+ *
+ * Values order like their serial numbers, by comparing their bytes, and
+ * `std::hash<tag_value>` is the serial number itself: distinct tags never
+ * collide, and the empty value hashes to `SIZE_MAX`, which no serial
+ * reaches.  Since every character sits at a fixed position, `serial()`
+ * needs no checks or per-character loop; with SSE2 it is a handful of
+ * vector operations, about as fast as hashing the characters.
+ */
+class alignas(16) tag_value{
+public:
+    /**
+     * @brief  the empty value
+     */
+    constexpr tag_value() noexcept = default;
+
+    /**
+     * @brief  the tag of a serial number, as `tag_encode()`
+     *
+     * @throw  std::out_of_range    thrown if the serial number is negative
+     *
+     * @param  serial   non-negative integer serial number
+     */
+    constexpr explicit tag_value(long int serial){
+        tag_encode_padded(serial, bytes + LENGTH_AT - TAG_MAX_LENGTH, TAG_MAX_LENGTH);
+        bytes[LENGTH_AT] = static_cast<char>(tag_encoded_length(serial));
+    }
+
+    /**
+     * @brief  the canonical form of a tag, as `tag_decode()` accepts it
+     *
+     * @throw  std::invalid_argument    thrown if `tag` is not a valid tag
+     *
+     * @param  tag  "tag" string; upper case and the aliases '0' and '1' are accepted
+     */
+    explicit tag_value(std::string_view tag) : tag_value(tag_decode(tag)){}
+
+    /**
+     * @brief  the canonical form of a tag, without throwing
+     *
+     * @param  tag  "tag" string; upper case and the aliases '0' and '1' are accepted
+     * @return      the value, or an empty optional if `tag` is not a valid tag
+     */
+    static constexpr std::optional<tag_value> try_parse(std::string_view tag) noexcept{
+        std::optional<long int> serial = tag_try_decode(tag);
+        if(!serial){
+            return std::nullopt;
+        }
+        return tag_value(*serial);                                                  // cannot throw: the serial is valid
+    }
+
+    /**
+     * @brief  the serial number of the tag, or -1 for the empty value
+     *
+     * Not counted by `TAG_ENCODE_STATS`, as hashing is not decoding.
+     */
+    constexpr long int serial() const noexcept{
+        using namespace tag_encode_detail;
+        if(empty()){
+            return -1;
+        }
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+        if(TAG_MAX_LENGTH == LENGTH_AT && !__builtin_is_constant_evaluated()){
+            const __m128i letter_base = _mm_setr_epi8(47, 47, 39, 47, 47, 39, 47, 47, 39, 47, 47, 39, 47, 47, 39, 0);   // 'a' - '2' - letter offset
+            const __m128i pair_low    = _mm_setr_epi16(radix(13), 1, radix(11), 1, radix(9), 1, radix(7), 1);
+            const __m128i pair_high   = _mm_setr_epi16(radix(5), 1, radix(3), 1, radix(1), 1, 1, 0);            // drops the length byte
+            const __m128i join_low    = _mm_set_epi64x(place(9) / place(7), place(13) / place(11));
+            const __m128i join_high   = _mm_set_epi64x(place(1) / place(0), place(5) / place(3));
+            __m128i chars  = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+            __m128i digits = _mm_sub_epi8(_mm_sub_epi8(chars, _mm_set1_epi8('2')), _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('9')), letter_base));
+            __m128i pairs_low  = _mm_madd_epi16(_mm_unpacklo_epi8(digits, _mm_setzero_si128()), pair_low);    // two positions per 32-bit lane
+            __m128i pairs_high = _mm_madd_epi16(_mm_unpackhi_epi8(digits, _mm_setzero_si128()), pair_high);
+            __m128i quads_low  = _mm_add_epi64(_mm_srli_epi64(pairs_low, 32), _mm_mul_epu32(pairs_low, join_low));    // four per 64-bit lane
+            __m128i quads_high = _mm_add_epi64(_mm_srli_epi64(pairs_high, 32), _mm_mul_epu32(pairs_high, join_high));
+            std::uint64_t q11 = _mm_cvtsi128_si64(quads_low),  q7 = _mm_cvtsi128_si64(_mm_unpackhi_epi64(quads_low, quads_low));
+            std::uint64_t q3  = _mm_cvtsi128_si64(quads_high), q0 = _mm_cvtsi128_si64(_mm_unpackhi_epi64(quads_high, quads_high));
+            return static_cast<long int>(q0 + q3 * place(3) + q7 * place(7) + q11 * place(11));
+        }
+#endif
+        unsigned long int value = 0;
+        for(int position = 0; position < TAG_MAX_LENGTH; position++){               // independent terms: no chain of multiplies
+            value += DIGITS.value[position % 3][static_cast<unsigned char>(bytes[LENGTH_AT - 1 - position])] * place(position);
+        }
+        return static_cast<long int>(value);
+    }
+
+    constexpr std::string_view view() const noexcept{ return std::string_view(bytes + LENGTH_AT - size(), size()); }
+    constexpr const char*      data() const noexcept{ return bytes + LENGTH_AT - size(); }
+    constexpr std::size_t      size() const noexcept{ return static_cast<unsigned char>(bytes[LENGTH_AT]); }
+    constexpr bool             empty() const noexcept{ return size() == 0; }
+    std::string                str() const{ return std::string(view()); }
+
+    friend constexpr bool operator==(const tag_value& a, const tag_value& b) noexcept{
+        return ((tag_encode_detail::load_le(a.bytes, 8) ^ tag_encode_detail::load_le(b.bytes, 8)) |
+                (tag_encode_detail::load_le(a.bytes + 8, 8) ^ tag_encode_detail::load_le(b.bytes + 8, 8))) == 0;
+    }
+    friend constexpr bool operator!=(const tag_value& a, const tag_value& b) noexcept{ return !(a == b); }
+    friend constexpr bool operator< (const tag_value& a, const tag_value& b) noexcept{ return a.padded() < b.padded(); }
+    friend constexpr bool operator> (const tag_value& a, const tag_value& b) noexcept{ return b < a; }
+    friend constexpr bool operator<=(const tag_value& a, const tag_value& b) noexcept{ return !(b < a); }
+    friend constexpr bool operator>=(const tag_value& a, const tag_value& b) noexcept{ return !(a < b); }
+
+private:
+    static constexpr int LENGTH_AT = 15;
+
+    char bytes[LENGTH_AT + 1] = {};                                                 // padded tag, right-aligned, then the length
+
+    /**
+     * @brief  the padded tag (all NULs if empty), which sorts in serial order
+     */
+    constexpr std::string_view padded() const noexcept{ return std::string_view(bytes, LENGTH_AT); }
+
+    static constexpr int           radix(int position){ return BASE_SELECT[position % 3]; }
+    static constexpr std::uint64_t place(int position){ return position == 0 ? 1 : tag_encode_detail::LENGTHS.limit[position - 1]; }
+};
+
+static_assert(sizeof(tag_value) == 16 && std::is_trivially_copyable<tag_value>::value && TAG_MAX_LENGTH <= 15,
+              "tag_value must stay a 16-byte trivially copyable key");
+
+namespace std{
+    /**
+     * @brief  hash of a tag: its serial number, so distinct tags never collide
+     */
+    template<>
+    struct hash<tag_value>{
+        std::size_t operator()(const tag_value& tag) const noexcept{
+            return static_cast<std::size_t>(tag.serial());                          // the empty value's -1 becomes SIZE_MAX
+        }
+    };
+}
+
+namespace tag_encode_detail{
+    /**
+     * @brief  serials below this fill only positions 1 and 2 of a checked tag (26 * 8)
+     */
+    constexpr long int CHECK_SHIFT = N_ALPHACASE * N_DIGITS;
+
+    /**
+     * @brief  Luhn mod 34 terms of every radix-34 symbol: `term[0]` as is, `term[1]` doubled
+     *
+     * Doubling sums the base-34 digits of `2 * symbol`, a permutation of [0, 34),
+     * so a changed symbol always changes the sum.
+     */
+    struct check_table{
+        unsigned char term[2][N_ALPHANUM];
+    };
+
+    constexpr check_table make_check_table(){
+        check_table table{};
+        for(int symbol = 0; symbol < N_ALPHANUM; symbol++){
+            table.term[0][symbol] = symbol;
+            table.term[1][symbol] = symbol < N_ALPHANUM / 2 ? 2 * symbol : 2 * symbol - (N_ALPHANUM - 1);
+        }
+        return table;
+    }
+
+    inline constexpr check_table CHECK_TERMS = make_check_table();
+
+    constexpr int SYMBOL_OFFSET[] = {0, N_DIGITS, 0};                               // digit value + offset = radix-34 symbol, per position class
+
+    /**
+     * @brief  check digit of the `count` characters in front of the check character
+     *
+     * Every character enters as its radix-34 symbol, so letters keep one value
+     * whichever class their position has; the character next to the check
+     * character and every second one before it are doubled.
+     */
+    constexpr int check_digit(const char* chars, std::size_t count){
+        int sum = 0;
+        for(std::size_t i = 0; i < count; i++){
+            sum += CHECK_TERMS.term[(count - i) % 2][DIGITS.value[0][static_cast<unsigned char>(chars[i])]];   // `count - i` is its position
+        }
+        return (N_ALPHANUM - sum % N_ALPHANUM) % N_ALPHANUM;
+    }
+}
+
+/**
+ * @brief  number of characters in the tag `tag_encode_checked()` produces for a serial number
+ *
+ * @throw  std::out_of_range    thrown if the serial number is negative
+ *
+ * @param  serial non-negative integer serial number
+ * @return        length of the checked tag, between 1 and `TAG_MAX_LENGTH_CHECKED`
+ */
+constexpr std::size_t tag_encoded_length_checked(long int serial){
+    if(serial < 0){
+        throw std::out_of_range("Serial number must be non-negative.");
+    }
+    if(serial >= tag_encode_detail::CHECK_SHIFT){
+        return 3 + tag_encoded_length(serial / tag_encode_detail::CHECK_SHIFT);
+    }
+    return serial >= N_ALPHACASE ? 3 : (serial > 0 ? 2 : 1);
+}
+
+/**
+ * @brief  length of the longest checked tag
+ */
+constexpr int TAG_MAX_LENGTH_CHECKED = tag_encoded_length_checked(std::numeric_limits<long int>::max());
+
+/**
+ * @brief  encode a non-negative integer as a tag ending in a check character
+ *
+ * Opt-in form of `tag_encode()` for tags that people type.  The last
+ * character is a Luhn mod 34 check digit over the radix-34 symbols of the
+ * others, and the serial number is written one position to its left, so the
+ * check character takes position 0 and the whole tag keeps the alternation
+ * of letters and digits; it is the ordinary tag of `serial * 34 + check`,
+ * and so not the tag `tag_encode()` gives `serial` with one character added.
+ * `tag_try_decode_checked()` refuses every single-character substitution and
+ * every transposition of adjacent characters except swapping '2' with 'z'.
+ * The tag is written right-aligned into `out` as by `tag_encode()`; a buffer
+ * of `TAG_MAX_LENGTH_CHECKED` bytes always suffices.
+ *
+ * @throw  std::out_of_range    thrown if the serial number is negative
+ * @throw  std::length_error    thrown if `out_size` is smaller than the tag length
+ *
+ * @param  serial   non-negative integer serial number
+ * @param  out      buffer receiving the tag characters
+ * @param  out_size size of `out` in bytes
+ * @return          number of characters written (the tag length)
+ */
+constexpr std::size_t tag_encode_checked(long int serial, char* out, std::size_t out_size){
+    using namespace tag_encode_detail;
+    TAG_ENCODE_STATS_BEGIN(encode);
+    std::size_t length = tag_encoded_length_checked(serial);
+    if(out_size < length){
+        throw std::length_error("Output buffer is too small for tag.");
+    }
+    char*             check = out + out_size - 1;
+    unsigned long int value = serial;
+    if(length > 1){
+        check[-1] = digit_char(value % N_ALPHACASE, N_ALPHACASE);                   // positions 1 and 2 by hand,
+    }
+    if(length > 2){
+        check[-2] = digit_char(value / N_ALPHACASE % N_DIGITS, N_DIGITS);
+    }
+    if(length > 3){                                                                 // then whole groups from position 3
+#if TAG_ENCODE_GROUP_TABLE
+        encode_groups(value / CHECK_SHIFT, check - 2);
+#else
+        encode_digits(value / CHECK_SHIFT, check - 2);
+#endif
+    }
+    *check = digit_char(check_digit(out + out_size - length, length - 1), N_ALPHANUM);
+    TAG_ENCODE_STATS_END(encode, length, -1);
+    return length;
+}
+
+/**
+ * @brief  encode a non-negative integer as a tag ending in a check character
+ *
+ * @see    tag_encode_checked(long int, char*, std::size_t)
+ *
+ * @throw  std::out_of_range    thrown if the serial number is negative
+ *
+ * @param  serial non-negative integer serial number
+ * @return        checked tag, one character longer than most plain tags
+ */
+inline std::string tag_encode_checked(long int serial){
+    char        tag[TAG_MAX_LENGTH_CHECKED];
+    std::size_t length = tag_encode_checked(serial, tag, TAG_MAX_LENGTH_CHECKED);
+    return std::string(tag + TAG_MAX_LENGTH_CHECKED - length, length);
+}
+
+namespace tag_encode_detail{
+    /**
+     * @brief  decoder of `tag_try_decode_checked()`
+     */
+    constexpr tag_decode_status decode_checked(std::string_view tag, long int& serial) noexcept{
+        if(tag.size() < 1){
+            return tag_decode_status::blank;
+        }
+        int                digit    = 0;
+        int                sum      = 0;
+        unsigned long long value    = 0;                                            // cannot wrap within TAG_MAX_LENGTH_CHECKED characters
+        std::size_t        tag_size = tag.size();
+        int                k        = (tag_size - 1) % 3;
+
+        for(std::size_t i = 0; i + 1 < tag_size; i++, k = (k == 0) ? 2 : k - 1){  // every character before the check
+            digit = DIGITS.value[k][static_cast<unsigned char>(tag[i])];
+            if(digit == INVALID_DIGIT){
+                return tag_decode_status::bad_char;
+            }
+            if(i == 0 && digit == 0){
+                return tag_decode_status::non_canonical;
+            }
+            sum  += CHECK_TERMS.term[(tag_size - 1 - i) % 2][digit + SYMBOL_OFFSET[k]];
+            value = value * BASE_SELECT[k] + digit;
+        }
+        digit = DIGITS.value[0][static_cast<unsigned char>(tag[tag_size - 1])];
+        if(digit == INVALID_DIGIT){
+            return tag_decode_status::bad_char;
+        }
+        if((sum + digit) % N_ALPHANUM != 0){
+            return tag_decode_status::bad_check;
+        }
+        if(tag_size > static_cast<std::size_t>(TAG_MAX_LENGTH_CHECKED) ||
+           value > static_cast<unsigned long long>(std::numeric_limits<long int>::max())){
+            return tag_decode_status::overflow;
+        }
+        serial = value;
+        return tag_decode_status::ok;
+    }
+}
+
+/**
+ * @brief  decode a tag written by `tag_encode_checked()`, verifying its check character
+ *
+ * One pass over the tag both accumulates the serial number and sums the
+ * check, so a mistyped tag is refused as `tag_decode_status::bad_check`
+ * (or `bad_char` if the typo breaks the alternation) for the cost of a
+ * plain decode.  Case and the '0'/'1' aliases are accepted as by
+ * `tag_try_decode()` and are not typos.
+ *
+ * @param  tag      checked tag
+ * @param  serial   receives the decoded serial number; left unchanged unless
+ *                  the result is `tag_decode_status::ok`
+ * @return          `tag_decode_status::ok` or the reason the tag is invalid
+ */
+constexpr tag_decode_status tag_try_decode_checked(std::string_view tag, long int& serial) noexcept{
+    TAG_ENCODE_STATS_BEGIN(decode);
+    tag_decode_status status = tag_encode_detail::decode_checked(tag, serial);
+    TAG_ENCODE_STATS_END(decode, tag.size(), static_cast<int>(status));
+    return status;
+}
+
+/**
+ * @brief  decode a tag written by `tag_encode_checked()`
+ *
+ * @see    tag_try_decode_checked(std::string_view, long int&)
+ *
+ * @throw  std::invalid_argument    thrown if `tag_try_decode_checked()` refuses the tag,
+ *                                  with a distinct message for a check character mismatch
+ *
+ * @param  tag checked tag
+ * @return     non-negative integer serial number
+ */
+inline long int tag_decode_checked(std::string_view tag){
+    long int          serial = 0;
+    tag_decode_status status = tag_try_decode_checked(tag, serial);
+    if(status != tag_decode_status::ok){
+        tag_encode_detail::throw_invalid_tag(tag, status);
+    }
+    return serial;
+}
+
+#if defined(__SIZEOF_INT128__)
+/**
+ * @brief  unsigned 128-bit serial number type (a GCC/Clang extension)
+ */
+__extension__ typedef unsigned __int128 tag_uint128_t;
+#endif
+
+namespace tag_encode_detail{
+    /**
+     * @brief  number of characters needed to encode the largest value of an unsigned type
+     */
+    template<typename Unsigned>
+    constexpr int wide_max_length(){
+        Unsigned    limit  = ~Unsigned(0);
+        Unsigned    bound  = 1;                                                     // smallest serial that needs `length+1` chars
+        int         length = 0;
+        while(true){
+            int digit_base = BASE_SELECT[length++ % 3];
+            if(bound > limit / digit_base){
+                return length;
+            }
+            bound *= digit_base;
+        }
+    }
+
+    /**
+     * @brief  tag-length thresholds of an unsigned type, laid out like `length_table`
+     */
+    template<typename Unsigned>
+    struct wide_length_table{
+        Unsigned            limit[wide_max_length<Unsigned>()];
+        unsigned char       by_width[8 * sizeof(Unsigned) + 1];
+    };
+
+    template<typename Unsigned>
+    constexpr wide_length_table<Unsigned> make_wide_length_table(){
+        constexpr int              max_length = wide_max_length<Unsigned>();
+        wide_length_table<Unsigned> table{};
+        Unsigned                   bound = 1;
+        for(int length = 1; length < max_length; length++){
+            bound *= BASE_SELECT[(length - 1) % 3];
+            table.limit[length - 1] = bound;
+        }
+        table.limit[max_length - 1] = ~Unsigned(0);
+        table.by_width[0] = 1;
+        for(std::size_t width = 1; width <= 8 * sizeof(Unsigned); width++){
+            Unsigned smallest = Unsigned(1) << (width - 1);
+            int      length   = 1;
+            while(smallest >= table.limit[length - 1]){
+                length++;
+            }
+            table.by_width[width] = length;
+        }
+        return table;
+    }
+
+    template<typename Unsigned>
+    inline constexpr wide_length_table<Unsigned> WIDE_LENGTHS = make_wide_length_table<Unsigned>();
+
+    constexpr int wide_bit_width(std::uint64_t value){
+#if defined(__GNUC__) || defined(__clang__)
+        return value == 0 ? 0 : 64 - __builtin_clzll(value);
+#else
+        int width = 0;
+        for(; value != 0; value >>= 1){
+            width++;
+        }
+        return width;
+#endif
+    }
+
+#if defined(__SIZEOF_INT128__)
+    constexpr int wide_bit_width(tag_uint128_t value){
+        std::uint64_t high = static_cast<std::uint64_t>(value >> 64);
+        return high != 0 ? 64 + wide_bit_width(high) : wide_bit_width(static_cast<std::uint64_t>(value));
+    }
+#endif
+
+    /**
+     * @brief  constant-time tag length, from the bit width and a single comparison
+     */
+    template<typename Unsigned>
+    constexpr std::size_t wide_length(Unsigned value){
+        static_assert(WIDE_LENGTHS<Unsigned>.by_width[8 * sizeof(Unsigned)] < wide_max_length<Unsigned>(),
+                      "the last threshold is a sentinel no value reaches");
+        int length = WIDE_LENGTHS<Unsigned>.by_width[wide_bit_width(value)];
+        return length + (value >= WIDE_LENGTHS<Unsigned>.limit[length - 1] ? 1 : 0);
+    }
+
+    /**
+     * @brief  shared decoder of the unsigned forms of `tag_try_decode()`
+     *
+     * Every character but the leading one of a full-length tag is accumulated
+     * without any risk of wrapping; that leading digit is then added with an
+     * overflow check against compile-time constants.
+     */
+    template<typename Unsigned>
+    constexpr tag_decode_status decode_wide(std::string_view tag, Unsigned& serial) noexcept{
+        constexpr std::size_t max_length = wide_max_length<Unsigned>();
+        if(tag.size() < 1){
+            return tag_decode_status::blank;
+        }
+        int         digit    = 0, lead = 0;
+        Unsigned    value    = 0;
+        std::size_t tag_size = tag.size();
+        int         k        = (tag_size - 1) % 3;                                  // position class of the leading character
+
+        for(std::size_t i = 0; i < tag_size; i++, k = (k == 0) ? 2 : k - 1){
+            digit = DIGITS.value[k][static_cast<unsigned char>(tag[i])];
+            if(digit == INVALID_DIGIT){
+                return tag_decode_status::bad_char;
+            }
+            if(i == 0 && digit == 0 && tag_size > 1){
+                return tag_decode_status::non_canonical;
+            }
+            if(i == 0 && tag_size == max_length){
+                lead = digit;                                                       // added last, with the overflow check
+                continue;
+            }
+            value = value * BASE_SELECT[k] + digit;
+        }
+        if(tag_size > max_length){
+            return tag_decode_status::overflow;
+        }
+        if(lead != 0){
+            constexpr Unsigned limit = ~Unsigned(0);
+            constexpr Unsigned scale = WIDE_LENGTHS<Unsigned>.limit[max_length - 2];   // weight of the leading character
+            if(static_cast<Unsigned>(lead) > limit / scale || value > limit - lead * scale){
+                return tag_decode_status::overflow;
+            }
+            value += lead * scale;
+        }
+        serial = value;
+        return tag_decode_status::ok;
+    }
+}
+
+/**
+ * @brief  maximum length of the tag of an unsigned 64-bit serial number (16)
+ */
+constexpr int TAG_MAX_LENGTH_U64 = tag_encode_detail::wide_max_length<std::uint64_t>();
+
+/**
+ * @brief  number of characters in the tag `tag_encode_u64()` produces
+ *
+ * @param  serial unsigned 64-bit serial number
+ * @return        length of the corresponding tag, between 1 and `TAG_MAX_LENGTH_U64`
+ */
+constexpr std::size_t tag_encoded_length_u64(std::uint64_t serial) noexcept{
+    return tag_encode_detail::wide_length(serial);
+}
+
+/**
+ * @brief  encode an unsigned 64-bit integer into a caller-supplied character buffer
+ *
+ * Unsigned counterpart of `tag_encode(long int, char*, std::size_t)` for the
+ * whole range of `std::uint64_t`.  Every serial number up to `LONG_MAX`
+ * encodes to the same tag as in `tag_encode()`; the larger ones continue the
+ * same radix schedule, up to 16 characters.  The tag is written right-aligned
+ * into `out`.
+ *
+ * @throw  std::length_error    thrown if `out_size` is smaller than the tag length
+ *
+ * @param  serial   unsigned 64-bit serial number
+ * @param  out      buffer receiving the tag characters
+ * @param  out_size size of `out` in bytes
+ * @return          number of characters written (the tag length)
+ */
+constexpr std::size_t tag_encode_u64(std::uint64_t serial, char* out, std::size_t out_size){
+    std::size_t length = tag_encoded_length_u64(serial);
+    if(out_size < length){
+        throw std::length_error("Output buffer is too small for tag.");
+    }
+    tag_encode_detail::encode_unsigned(serial, out + out_size);
+    return length;
+}
+
+/**
+ * @brief  encode an unsigned 64-bit integer into alphanumeric "tag" string
+ *
+ * @remark  The maximum of 18446744073709551615 encodes as 32iw8m37xg8yz4dj -- 16 characters.
+ *
+ * @param  serial unsigned 64-bit serial number
+ * @return        alphanumeric "tag" string, as `tag_encode()` would produce
+ */
+inline std::string tag_encode_u64(std::uint64_t serial){
+    char        tag[TAG_MAX_LENGTH_U64];
+    std::size_t length = tag_encode_u64(serial, tag, TAG_MAX_LENGTH_U64);
+    return std::string(tag + TAG_MAX_LENGTH_U64 - length, length);
+}
+
+/**
+ * @brief  decode a tag into an unsigned 64-bit integer without throwing
+ *
+ * @see    tag_try_decode(std::string_view, long int&)
+ *
+ * @param  tag      "tag" string, at most `TAG_MAX_LENGTH_U64` characters
+ * @param  serial   receives the decoded serial number; left unchanged unless
+ *                  the result is `tag_decode_status::ok`
+ * @return          `tag_decode_status::ok` or the reason the tag is invalid
+ */
+constexpr tag_decode_status tag_try_decode_u64(std::string_view tag, std::uint64_t& serial) noexcept{
+    return tag_encode_detail::decode_wide(tag, serial);
+}
+
+/**
+ * @brief  decode a tag into an unsigned 64-bit integer
+ *
+ * @throw  std::invalid_argument    thrown if the tag is blank, malformed or exceeds `std::uint64_t`
+ *
+ * @param  tag "tag" string as produced by `tag_encode_u64()`
+ * @return     the serial number
+ */
+inline std::uint64_t tag_decode_u64(std::string_view tag){
+    std::uint64_t     serial = 0;
+    tag_decode_status status = tag_try_decode_u64(tag, serial);
+    if(status != tag_decode_status::ok){
+        tag_encode_detail::throw_invalid_tag(tag, status);
+    }
+    return serial;
+}
+
+#if defined(__SIZEOF_INT128__)
+namespace tag_encode_detail{
+    /**
+     * @brief  radix of one 64-bit limb of a 128-bit serial: five groups, fifteen characters
+     *
+     * 7072^5 lies just above 2^63, so the radix is already normalized (top bit
+     * set) for the two-by-one division below, and no shifting is needed.
+     */
+    constexpr std::uint64_t WIDE_LIMB_BASE = static_cast<std::uint64_t>(GROUP_BASE) * GROUP_BASE * GROUP_BASE * GROUP_BASE * GROUP_BASE;
+    constexpr int           WIDE_LIMB_CHARS = 15;
+
+    static_assert(WIDE_LIMB_BASE >> 63 == 1, "the limb radix must be normalized");
+
+    /**
+     * @brief  reciprocal of the limb radix: floor((2^128 - 1) / d) - 2^64, computed at compile time
+     */
+    constexpr std::uint64_t WIDE_LIMB_RECIPROCAL = static_cast<std::uint64_t>(~tag_uint128_t(0) / WIDE_LIMB_BASE);
+
+    /**
+     * @brief  divide `value` by the limb radix in place and return the remainder
+     *
+     * Two-by-one division with a precomputed reciprocal (Möller and Granlund,
+     * "Improved division by invariant integers", 2011): two 64-bit multiplies
+     * and two rare corrections instead of a call to the 128-bit division
+     * routine, which compilers emit even for constant divisors.
+     */
+    constexpr std::uint64_t divide_limb(tag_uint128_t& value){
+        std::uint64_t high          = static_cast<std::uint64_t>(value >> 64);
+        std::uint64_t low           = static_cast<std::uint64_t>(value);
+        std::uint64_t quotient_high = high >= WIDE_LIMB_BASE ? 1 : 0;              // the radix exceeds 2^63: at most 1
+        high -= quotient_high * WIDE_LIMB_BASE;
+
+        tag_uint128_t estimate = static_cast<tag_uint128_t>(WIDE_LIMB_RECIPROCAL) * high +
+                                 ((static_cast<tag_uint128_t>(high) << 64) | low);
+        std::uint64_t quotient  = static_cast<std::uint64_t>(estimate >> 64) + 1;
+        std::uint64_t remainder = low - quotient * WIDE_LIMB_BASE;
+        if(remainder > static_cast<std::uint64_t>(estimate)){
+            quotient--;
+            remainder += WIDE_LIMB_BASE;
+        }
+        if(remainder >= WIDE_LIMB_BASE){
+            quotient++;
+            remainder -= WIDE_LIMB_BASE;
+        }
+        value = (static_cast<tag_uint128_t>(quotient_high) << 64) | quotient;
+        return remainder;
+    }
+
+    /**
+     * @brief  write all fifteen characters of one limb, zero padding included
+     */
+    constexpr void encode_limb(std::uint64_t limb, char* tag_end){
+        for(int group = 0; group < WIDE_LIMB_CHARS / 3; group++){
+            tag_end -= 3;
+            copy_chars(tag_end, GROUPS.triplet[limb % GROUP_BASE], 3);
+            limb    /= GROUP_BASE;
+        }
+    }
+
+    /**
+     * @brief  128-bit encoder: 64-bit limbs of fifteen characters, written backwards from `tag_end`
+     */
+    constexpr void encode_u128(tag_uint128_t value, char* tag_end){
+        while(value >= WIDE_LIMB_BASE){
+            encode_limb(divide_limb(value), tag_end);
+            tag_end -= WIDE_LIMB_CHARS;
+        }
+        encode_unsigned(static_cast<std::uint64_t>(value), tag_end);
+    }
+}
+
+/**
+ * @brief  maximum length of the tag of an unsigned 128-bit serial number (31)
+ */
+constexpr int TAG_MAX_LENGTH_U128 = tag_encode_detail::wide_max_length<tag_uint128_t>();
+
+/**
+ * @brief  number of characters in the tag `tag_encode_u128()` produces
+ *
+ * @param  serial unsigned 128-bit serial number
+ * @return        length of the corresponding tag, between 1 and `TAG_MAX_LENGTH_U128`
+ */
+constexpr std::size_t tag_encoded_length_u128(tag_uint128_t serial) noexcept{
+    return tag_encode_detail::wide_length(serial);
+}
+
+/**
+ * @brief  encode an unsigned 128-bit integer into a caller-supplied character buffer
+ *
+ * Extends `tag_encode_u64()` to 128-bit serial numbers, up to 31 characters;
+ * every value that fits in 64 bits gets the same tag.  The value is split
+ * into 64-bit limbs of fifteen characters each with a reciprocal
+ * multiplication, so no 128-bit division is performed at run time.  The tag
+ * is written right-aligned into `out`.
+ *
+ * @throw  std::length_error    thrown if `out_size` is smaller than the tag length
+ *
+ * @param  serial   unsigned 128-bit serial number
+ * @param  out      buffer receiving the tag characters
+ * @param  out_size size of `out` in bytes
+ * @return          number of characters written (the tag length)
+ */
+constexpr std::size_t tag_encode_u128(tag_uint128_t serial, char* out, std::size_t out_size){
+    std::size_t length = tag_encoded_length_u128(serial);
+    if(out_size < length){
+        throw std::length_error("Output buffer is too small for tag.");
+    }
+    tag_encode_detail::encode_u128(serial, out + out_size);
+    return length;
+}
+
+/**
+ * @brief  encode an unsigned 128-bit integer into alphanumeric "tag" string
+ *
+ * @param  serial unsigned 128-bit serial number
+ * @return        alphanumeric "tag" string
+ */
+inline std::string tag_encode_u128(tag_uint128_t serial){
+    char        tag[TAG_MAX_LENGTH_U128];
+    std::size_t length = tag_encode_u128(serial, tag, TAG_MAX_LENGTH_U128);
+    return std::string(tag + TAG_MAX_LENGTH_U128 - length, length);
+}
+
+/**
+ * @brief  decode a tag into an unsigned 128-bit integer without throwing
+ *
+ * @see    tag_try_decode(std::string_view, long int&)
+ *
+ * @param  tag      "tag" string, at most `TAG_MAX_LENGTH_U128` characters
+ * @param  serial   receives the decoded serial number; left unchanged unless
+ *                  the result is `tag_decode_status::ok`
+ * @return          `tag_decode_status::ok` or the reason the tag is invalid
+ */
+constexpr tag_decode_status tag_try_decode_u128(std::string_view tag, tag_uint128_t& serial) noexcept{
+    return tag_encode_detail::decode_wide(tag, serial);
+}
+
+/**
+ * @brief  decode a tag into an unsigned 128-bit integer
+ *
+ * @throw  std::invalid_argument    thrown if the tag is blank, malformed or exceeds 128 bits
+ *
+ * @param  tag "tag" string as produced by `tag_encode_u128()`
+ * @return     the serial number
+ */
+inline tag_uint128_t tag_decode_u128(std::string_view tag){
+    tag_uint128_t     serial = 0;
+    tag_decode_status status = tag_try_decode_u128(tag, serial);
+    if(status != tag_decode_status::ok){
+        tag_encode_detail::throw_invalid_tag(tag, status);
+    }
+    return serial;
+}
+#endif
+
+/**
+ * @brief  keyed, reversible scrambling of serial numbers before they are encoded
+ *
+ * Plain tags reveal how many rows exist and in what order they were made:
+ * consecutive serials get consecutive tags.  A `tag_scrambler` applies a
+ * keyed permutation of `[0, 2^bits)` to each serial before `tag_encode()`
+ * and inverts it after decoding, so neighbouring serials give unrelated
+ * tags while the mapping stays one-to-one and needs no lookup table.  Tags
+ * are no longer than the largest tag of the domain (`bits` = 35 keeps them
+ * within 8 characters, for example).
+ *
+ * The permutation is an alternating Feistel network on the two halves of
+ * the serial (`bits - bits/2` and `bits/2` wide, so any domain width works
+ * without cycle walking) with `ROUNDS` rounds, the minimum for a Feistel
+ * network to be a strong pseudorandom permutation given good round
+ * functions.  Each round function is one multiplication by a keyed odd
+ * constant; the round keys are derived from the 128-bit key and the domain
+ * width once, in the constructor, so a scrambled encode costs a few
+ * nanoseconds more than a plain one.
+ *
+ * @remark  This hides sequence and volume from casual observation; it is not
+ *          encryption.  The round function is a fast multiplicative hash and
+ *          the construction has not been analysed as a cipher, so do not rely
+ *          on it against a determined adversary.  Anyone with the key can
+ *          invert the mapping.
+ */
+class tag_scrambler{
+public:
+    static constexpr int ROUNDS = 4;                                                // even: each pair of rounds updates both halves
+
+    /**
+     * @brief  derive the round keys of a 128-bit key for serials in `[0, 2^bits)`
+     *
+     * @throw  std::invalid_argument    thrown if `bits` is not between 2 and 63
+     *
+     * @param  key_high high 64 bits of the secret key
+     * @param  key_low  low 64 bits of the secret key
+     * @param  bits     width of the serial number domain (63 covers every non-negative 'long int')
+     */
+    constexpr tag_scrambler(std::uint64_t key_high, std::uint64_t key_low, int bits = 63) :
+        round_add{}, round_mul{}, domain_bits(bits){
+        if(bits < 2 || bits > 63){
+            throw std::invalid_argument("Scrambler domain must be 2 to 63 bits wide.");
+        }
+        std::uint64_t seed  = key_low ^ (static_cast<std::uint64_t>(bits) << 56);     // a different permutation per domain
+        std::uint64_t state = key_high ^ split_mix(seed);                           // every round key depends on all 128 key bits
+        for(int r = 0; r < ROUNDS; r++){
+            round_add[r] = split_mix(state);
+            round_mul[r] = split_mix(state) | 1;                                    // odd: every bit of the input reaches the top half
+        }
+    }
+
+    /**
+     * @brief  width of the serial number domain in bits
+     */
+    constexpr int bits() const noexcept{
+        return domain_bits;
+    }
+
+    /**
+     * @brief  map a serial number to its scrambled counterpart in the same domain
+     *
+     * @throw  std::out_of_range    thrown if `serial` is negative or not below `2^bits()`
+     */
+    constexpr long int scramble(long int serial) const{
+        std::uint64_t value     = checked(serial);
+        int           high_bits = domain_bits - domain_bits / 2, low_bits = domain_bits / 2;
+        std::uint64_t high      = value >> low_bits, low = value & mask(low_bits);
+        for(int r = 0; r < ROUNDS; r += 2){                                         // two rounds, one on each half
+            high ^= round(low, r, high_bits);
+            low  ^= round(high, r + 1, low_bits);
+        }
+        return static_cast<long int>((high << low_bits) | low);
+    }
+
+    /**
+     * @brief  invert `scramble()`
+     *
+     * @throw  std::out_of_range    thrown if `serial` is negative or not below `2^bits()`
+     */
+    constexpr long int unscramble(long int serial) const{
+        std::uint64_t value     = checked(serial);
+        int           high_bits = domain_bits - domain_bits / 2, low_bits = domain_bits / 2;
+        std::uint64_t high      = value >> low_bits, low = value & mask(low_bits);
+        for(int r = ROUNDS - 2; r >= 0; r -= 2){                                    // the same rounds in reverse order
+            low  ^= round(high, r + 1, low_bits);
+            high ^= round(low, r, high_bits);
+        }
+        return static_cast<long int>((high << low_bits) | low);
+    }
+
+    /**
+     * @brief  `tag_encode()` of the scrambled serial number, into a caller-supplied buffer
+     *
+     * @throw  std::out_of_range    thrown if `serial` is outside the domain
+     * @throw  std::length_error    thrown if `out_size` is smaller than the tag length
+     */
+    constexpr std::size_t encode(long int serial, char* out, std::size_t out_size) const{
+        return tag_encode(scramble(serial), out, out_size);
+    }
+
+    /**
+     * @brief  `tag_encode()` of the scrambled serial number
+     *
+     * @throw  std::out_of_range    thrown if `serial` is outside the domain
+     */
+    std::string encode(long int serial) const{
+        return tag_encode(scramble(serial));
+    }
+
+    /**
+     * @brief  decode a scrambled tag without throwing
+     *
+     * @param  tag      tag produced by `encode()` with the same key and domain
+     * @param  serial   receives the original serial number; left unchanged unless
+     *                  the result is `tag_decode_status::ok`
+     * @return          `tag_decode_status::ok`, the reason `tag_try_decode()` refused the
+     *                  tag, or `tag_decode_status::overflow` if it lies outside the domain
+     */
+    constexpr tag_decode_status try_decode(std::string_view tag, long int& serial) const noexcept{
+        long int          scrambled = 0;
+        tag_decode_status status    = tag_try_decode(tag, scrambled);
+        if(status != tag_decode_status::ok){
+            return status;
+        }
+        if(static_cast<std::uint64_t>(scrambled) >> domain_bits != 0){
+            return tag_decode_status::overflow;
+        }
+        serial = unscramble(scrambled);
+        return tag_decode_status::ok;
+    }
+
+    /**
+     * @brief  decode a scrambled tag back to the original serial number
+     *
+     * @throw  std::invalid_argument    thrown if the tag is blank, malformed or outside the domain
+     */
+    long int decode(std::string_view tag) const{
+        long int          serial = 0;
+        tag_decode_status status = try_decode(tag, serial);
+        if(status != tag_decode_status::ok){
+            tag_encode_detail::throw_invalid_tag(tag, status);
+        }
+        return serial;
+    }
+
+private:
+    static constexpr std::uint64_t split_mix(std::uint64_t& state){
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static constexpr std::uint64_t mask(int width){
+        return (std::uint64_t(1) << width) - 1;
+    }
+
+    /**
+     * @brief  round function: the top `width` bits of a keyed product, which every input bit influences
+     */
+    constexpr std::uint64_t round(std::uint64_t half, int r, int width) const{
+        return ((half + round_add[r]) * round_mul[r]) >> (64 - width);
+    }
+
+    constexpr std::uint64_t checked(long int serial) const{
+        if(serial < 0 || static_cast<std::uint64_t>(serial) >> domain_bits != 0){
+            throw std::out_of_range("Serial number is outside the scrambler domain.");
+        }
+        return static_cast<std::uint64_t>(serial);
+    }
+
+    std::uint64_t   round_add[ROUNDS];
+    std::uint64_t   round_mul[ROUNDS];
+    int             domain_bits;
+};
+
+/**
+ * @brief  one position class of a `tag_codec` schedule: the `Radix` symbols of the alphabet from index `First`
+ */
+template<int First, int Radix>
+struct tag_radix{
+    static constexpr int first = First;
+    static constexpr int radix = Radix;
+};
+
+/**
+ * @brief  the alphabet of `tag_encode()`, as a `tag_codec` alphabet
+ *
+ * An alphabet type has two `std::string_view` members: `symbols`, the
+ * characters that tags are written with, and `aliases`, pairs of an input
+ * character and the symbol it is read as.  Letters are also accepted in the
+ * other case, unless that case is a symbol of its own.
+ */
+struct tag_alphabet_default{
+    static constexpr std::string_view symbols = "23456789abcdefghijklmnopqrstuvwxyz";
+    static constexpr std::string_view aliases = "0o1l";                              // "user-proof" 0's as o's and 1's as l's
+};
+
+namespace tag_encode_detail{
+    /**
+     * @brief  the radix schedule and group width of a `tag_codec`, all computed at compile time
+     *
+     * A group is as many whole periods of the schedule as keep its radix
+     * within `GROUP_LIMIT`, so a group table has at most that many entries:
+     * one period (7072) for the default schedule, three decimal digits for a
+     * schedule of radix 10.
+     */
+    template<typename Alphabet, typename... Schedule>
+    struct codec_layout{
+        static constexpr unsigned long GROUP_LIMIT = 8192;
+        static constexpr int           period      = sizeof...(Schedule);
+        static constexpr int           first[]     = {Schedule::first...};
+        static constexpr int           radix[]     = {Schedule::radix...};
+
+        static constexpr unsigned long period_base(){
+            unsigned long base = 1;
+            for(int k = 0; k < period; k++){
+                base *= radix[k];
+            }
+            return base;
+        }
+
+        static constexpr int periods_per_group(){
+            int           periods = 1;
+            unsigned long base    = period_base();
+            while(base * period_base() <= GROUP_LIMIT){
+                base *= period_base();
+                periods++;
+            }
+            return periods;
+        }
+
+        static constexpr int           span       = period * periods_per_group();  // characters per group
+        static constexpr unsigned long group_base = [](){
+            unsigned long base = 1;
+            for(int p = 0; p < span; p++){
+                base *= radix[p % period];
+            }
+            return base;
+        }();
+
+        /**
+         * @brief  length of the tag of `LONG_MAX`
+         */
+        static constexpr int max_length(){
+            unsigned long bound = 1;
+            for(int length = 1;; length++){
+                if(bound > static_cast<unsigned long>(std::numeric_limits<long int>::max()) / radix[(length - 1) % period]){
+                    return length;
+                }
+                bound *= radix[(length - 1) % period];
+            }
+        }
+
+        /**
+         * @brief  true if the schedule picks distinct symbols from within the alphabet
+         */
+        static constexpr bool valid(){
+            for(int k = 0; k < period; k++){
+                if(radix[k] < 2 || first[k] < 0 || first[k] + radix[k] > static_cast<int>(Alphabet::symbols.size())){
+                    return false;
+                }
+                for(int i = first[k]; i < first[k] + radix[k]; i++){
+                    for(int j = first[k]; j < i; j++){
+                        if(Alphabet::symbols[i] == Alphabet::symbols[j]){
+                            return false;
+                        }
+                    }
+                }
+            }
+            return Alphabet::aliases.size() % 2 == 0;
+        }
+    };
+
+    /**
+     * @brief  the `span` characters (most-significant first) of every group of a `tag_codec`
+     */
+    template<typename Layout>
+    struct codec_groups{
+        char chars[Layout::group_base][Layout::span];
+    };
+
+    template<typename Alphabet, typename Layout>
+    constexpr codec_groups<Layout> make_codec_groups(){
+        codec_groups<Layout> table{};
+        for(unsigned long group = 0; group < Layout::group_base; group++){
+            unsigned long value = group;
+            for(int p = 0; p < Layout::span; p++){                                  // least-significant character first
+                int k = p % Layout::period;
+                table.chars[group][Layout::span - 1 - p] = Alphabet::symbols[Layout::first[k] + value % Layout::radix[k]];
+                value /= Layout::radix[k];
+            }
+        }
+        return table;
+    }
+
+    /**
+     * @brief  ASCII case swap, or 0 for a byte that is not a letter
+     */
+    constexpr unsigned char other_case(unsigned char c){
+        if(c >= 'a' && c <= 'z'){
+            return c - 'a' + 'A';
+        }
+        return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : 0;
+    }
+
+    /**
+     * @brief  digit value of every input byte, per position class of a `tag_codec`
+     *
+     * Other-case letters and aliases are entered first, so that a byte that
+     * is itself a symbol always keeps its own value.
+     */
+    template<typename Layout>
+    struct codec_digits{
+        unsigned char value[Layout::period][256];
+    };
+
+    template<typename Alphabet, typename Layout>
+    constexpr codec_digits<Layout> make_codec_digits(){
+        codec_digits<Layout> table{};
+        for(int k = 0; k < Layout::period; k++){
+            for(int c = 0; c < 256; c++){
+                table.value[k][c] = INVALID_DIGIT;
+            }
+            auto enter = [&](unsigned char c, int digit){
+                table.value[k][c] = digit;
+                if(other_case(c) != 0 && Alphabet::symbols.find(static_cast<char>(other_case(c))) == std::string_view::npos){
+                    table.value[k][other_case(c)] = digit;
+                }
+            };
+            std::string_view symbols = Alphabet::symbols.substr(Layout::first[k], Layout::radix[k]);
+            for(std::size_t a = 0; a < Alphabet::aliases.size(); a += 2){
+                std::size_t digit = symbols.find(Alphabet::aliases[a + 1]);
+                if(digit != std::string_view::npos && Alphabet::symbols.find(Alphabet::aliases[a]) == std::string_view::npos){
+                    enter(Alphabet::aliases[a], digit);
+                }
+            }
+            for(int digit = 0; digit < Layout::radix[k]; digit++){
+                enter(symbols[digit], digit);
+            }
+            for(int digit = 0; digit < Layout::radix[k]; digit++){                  // exact symbols win over other-case letters
+                table.value[k][static_cast<unsigned char>(symbols[digit])] = digit;
+            }
+        }
+        return table;
+    }
+
+    /**
+     * @brief  the smallest serial number of each tag length of a `tag_codec`, and the length by bit width
+     *
+     * As `length_table`: since every radix is at least 2, no power-of-two
+     * interval contains more than one threshold.
+     */
+    template<typename Layout>
+    struct codec_lengths{
+        unsigned long int   limit[Layout::max_length()];
+        unsigned char       by_width[std::numeric_limits<unsigned long int>::digits + 1];
+    };
+
+    template<typename Layout>
+    constexpr codec_lengths<Layout> make_codec_lengths(){
+        codec_lengths<Layout> table{};
+        unsigned long int bound = 1;
+        for(int length = 1; length < Layout::max_length(); length++){
+            bound *= Layout::radix[(length - 1) % Layout::period];
+            table.limit[length - 1] = bound;
+        }
+        table.limit[Layout::max_length() - 1] = std::numeric_limits<unsigned long int>::max();
+        table.by_width[0] = 1;
+        for(int width = 1; width <= std::numeric_limits<unsigned long int>::digits; width++){
+            unsigned long int smallest = 1UL << (width - 1);
+            int               length   = 1;
+            while(smallest >= table.limit[length - 1]){
+                length++;
+            }
+            table.by_width[width] = length;
+        }
+        return table;
+    }
+}
+
+/**
+ * @brief  a tag encoder and decoder for any alphabet and radix schedule, specialized at compile time
+ *
+ * `Schedule` lists the position classes from the rightmost (least
+ * significant) character and repeats from the start, so the tags of
+ * `tag_encode()` are those of
+ * `tag_codec<tag_alphabet_default, tag_radix<0, 34>, tag_radix<8, 26>, tag_radix<0, 8>>`
+ * (`tag_default_codec`).  Each instantiation has its own group table,
+ * decode table and length thresholds, built by the compiler, and every
+ * radix and group size is a compile-time constant that divisions are
+ * reduced to multiplications by; a variant alphabet therefore costs no
+ * more than the default one, with no run-time configuration to branch on.
+ *
+ * The free functions stay the default codec, with its batch, padded,
+ * checked and wide forms; a `tag_codec` provides the single-tag functions.
+ *
+ *     struct label_alphabet{                                  // printed labels: no I or O
+ *         static constexpr std::string_view symbols = "23456789ABCDEFGHJKLMNPQRSTUVWXYZ";
+ *         static constexpr std::string_view aliases = "";      // lower case is still accepted
+ *     };
+ *     using label_codec = tag_codec<label_alphabet, tag_radix<0, 32>, tag_radix<8, 24>, tag_radix<0, 8>>;
+ *     label_codec::encode(2147483646);                        // "BS9CP4RY"
+ *
+ * @remark  A group is as many whole periods of the schedule as fit in 8192
+ *          values; a schedule whose period alone exceeds 65536 values is
+ *          rejected, as its table would be too large.
+ */
+template<typename Alphabet, typename... Schedule>
+class tag_codec{
+    using layout = tag_encode_detail::codec_layout<Alphabet, Schedule...>;
+
+    static_assert(sizeof...(Schedule) > 0, "a tag_codec needs at least one position class");
+    static_assert(layout::valid(), "each tag_radix must select distinct symbols within the alphabet");
+    static_assert(layout::period_base() <= 65536, "the schedule's period is too wide for a group table");
+
+    static constexpr tag_encode_detail::codec_groups<layout>  GROUPS  = tag_encode_detail::make_codec_groups<Alphabet, layout>();
+    static constexpr tag_encode_detail::codec_digits<layout>  DIGITS  = tag_encode_detail::make_codec_digits<Alphabet, layout>();
+    static constexpr tag_encode_detail::codec_lengths<layout> LENGTHS = tag_encode_detail::make_codec_lengths<layout>();
+
+public:
+    static constexpr int max_length = layout::max_length();                         // characters in the tag of LONG_MAX
+
+    /**
+     * @brief  number of characters in the tag of a serial number
+     *
+     * @throw  std::out_of_range    thrown if the serial number is negative
+     */
+    static constexpr std::size_t encoded_length(long int serial){
+        if(serial < 0){
+            throw std::out_of_range("Serial number must be non-negative.");
+        }
+        unsigned long int value  = serial;
+        int               length = LENGTHS.by_width[tag_encode_detail::bit_width(value)];
+        return length + (value >= LENGTHS.limit[length - 1] ? 1 : 0);
+    }
+
+    /**
+     * @brief  encode a serial number right-aligned into a caller-supplied buffer
+     *
+     * @see    tag_encode(long int, char*, std::size_t)
+     *
+     * @throw  std::out_of_range    thrown if the serial number is negative
+     * @throw  std::length_error    thrown if `out_size` is smaller than the tag length
+     */
+    static constexpr std::size_t encode(long int serial, char* out, std::size_t out_size){
+        std::size_t length = encoded_length(serial);
+        if(out_size < length){
+            throw std::length_error("Output buffer is too small for tag.");
+        }
+        unsigned long int value   = serial;
+        char*             tag_end = out + out_size;
+        for(std::size_t groups = (length - 1) / layout::span; groups > 0; groups--){    // unsigned division by a constant
+            tag_end -= layout::span;
+            tag_encode_detail::copy_chars(tag_end, GROUPS.chars[value % layout::group_base], layout::span);
+            value   /= layout::group_base;
+        }
+        std::size_t leading = (length - 1) % layout::span + 1;                      // leading group without its zero padding
+        tag_encode_detail::copy_chars(tag_end - leading, GROUPS.chars[value] + layout::span - leading, leading);
+        return length;
+    }
+
+    /**
+     * @brief  encode a serial number into a tag string
+     *
+     * @throw  std::out_of_range    thrown if the serial number is negative
+     */
+    static std::string encode(long int serial){
+        char        tag[max_length];
+        std::size_t length = encode(serial, tag, max_length);
+        return std::string(tag + max_length - length, length);
+    }
+
+    /**
+     * @brief  decode a tag without throwing
+     *
+     * @see    tag_try_decode(std::string_view, long int&)
+     *
+     * @param  tag      tag of this codec
+     * @param  serial   receives the decoded serial number; left unchanged unless
+     *                  the result is `tag_decode_status::ok`
+     * @return          `tag_decode_status::ok` or the reason the tag is invalid
+     */
+    static constexpr tag_decode_status try_decode(std::string_view tag, long int& serial) noexcept{
+        if(tag.size() < 1){
+            return tag_decode_status::blank;
+        }
+        unsigned long int value = 0;                                                // below the lead's weight: cannot wrap
+        int               lead  = 0;
+        int               k     = (tag.size() - 1) % layout::period;
+        for(std::size_t i = 0; i < tag.size(); i++, k = (k == 0) ? layout::period - 1 : k - 1){
+            int digit = DIGITS.value[k][static_cast<unsigned char>(tag[i])];
+            if(digit == tag_encode_detail::INVALID_DIGIT){
+                return tag_decode_status::bad_char;
+            }
+            if(i == 0 && digit == 0 && tag.size() > 1){
+                return tag_decode_status::non_canonical;
+            }
+            if(i == 0 && tag.size() == static_cast<std::size_t>(max_length)){
+                lead = digit;                                                       // added last, with the overflow check
+                continue;
+            }
+            value = value * layout::radix[k] + digit;
+        }
+        if(tag.size() > static_cast<std::size_t>(max_length)){
+            return tag_decode_status::overflow;
+        }
+        if(lead != 0){
+            constexpr unsigned long int limit = std::numeric_limits<long int>::max();
+            constexpr unsigned long int scale = LENGTHS.limit[max_length - 2];      // weight of the leading character
+            if(static_cast<unsigned long int>(lead) > limit / scale || value > limit - lead * scale){
+                return tag_decode_status::overflow;
+            }
+            value += lead * scale;
+        }
+        serial = value;
+        return tag_decode_status::ok;
+    }
+
+    /**
+     * @brief  decode a tag
+     *
+     * @throw  std::invalid_argument    thrown if the tag is blank, malformed or exceeds `long int`
+     */
+    static long int decode(std::string_view tag){
+        long int          serial = 0;
+        tag_decode_status status = try_decode(tag, serial);
+        if(status != tag_decode_status::ok){
+            tag_encode_detail::throw_invalid_tag(tag, status);
+        }
+        return serial;
+    }
+};
+
+/**
+ * @brief  the codec of `tag_encode()` and `tag_decode()`
+ */
+using tag_default_codec = tag_codec<tag_alphabet_default, tag_radix<0, N_ALPHANUM>, tag_radix<N_DIGITS, N_ALPHACASE>, tag_radix<0, N_DIGITS>>;
+
+#if defined(__cpp_consteval)
+#define TAG_ENCODE_CONSTEVAL consteval
+#else
+#define TAG_ENCODE_CONSTEVAL constexpr
+#endif
+
+inline namespace tag_literals{
+    /**
+     * @brief  decode a tag literal at compile time: `"ba9n82dq"_tag == 2147483646`
+     *
+     * Accepts the same tags as `tag_decode()`.  An invalid literal is a
+     * compile error; under C++17 that holds wherever the result is used in
+     * a constant expression (e.g. to initialize a `constexpr` variable), and
+     * under C++20 the literal is always evaluated by the compiler.
+     *
+     * @throw  std::invalid_argument    (at compile time) if the literal is not a valid tag
+     */
+    TAG_ENCODE_CONSTEVAL long int operator""_tag(const char* tag, std::size_t length){
+        long int serial = 0;
+        if(tag_try_decode(std::string_view(tag, length), serial) != tag_decode_status::ok){
+            throw std::invalid_argument("Invalid tag literal.");
+        }
+        return serial;
     }
-                                                                                    
-    return serial;                                                                  // return only if all is well
 }
 
 #endif
@@ -0,0 +1,525 @@
+/**
+ * @file tag_encode_cli.cpp
+ *
+ * The `tag_encode` command-line tool: bulk encoding of serial numbers to
+ * tags (or decoding of tags to serial numbers) for newline-delimited files
+ * or one column of a delimited (CSV-like) file.
+ *
+ *     tag_encode [-d] [-c] [-t delim] [-f field] [-H] [-j threads] [-r rejects] [-q] [file...]
+ *
+ * Files are memory-mapped; standard input is read in large blocks.  Input is
+ * cut at line boundaries into chunks that a pool of threads converts in
+ * parallel, and the converted chunks are written in input order with large
+ * writes.  Rows that cannot be converted are left out of the output and
+ * reported, with their line number and the reason, to the reject stream
+ * (standard error unless `-r` names a file) without stopping the run.
+ * Throughput counters are printed to standard error at the end.
+ *
+ * Build (POSIX):
+ *     g++ -std=c++17 -O2 -march=native -pthread -o tag_encode tag_encode_cli.cpp
+ *
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<cerrno>
+#include<limits>
+#include<algorithm>
+#include<string>
+#include<string_view>
+#include<vector>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<atomic>
+#include<functional>
+#include<chrono>
+#include<charconv>
+
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+
+#include "tag_encode.h"
+
+namespace{
+    constexpr std::size_t CHUNK_SIZE        = 1 << 20;                              // input bytes per parallel task (rounded up to a line)
+    constexpr std::size_t CHUNKS_PER_THREAD = 4;                                    // tasks per thread between ordered writes
+
+    /**
+     * @brief  command-line settings
+     */
+    struct options{
+        bool        decode      = false;                                            // tags to serials instead of serials to tags
+        bool        checked     = false;                                            // tags end in a check character
+        char        delimiter   = ',';
+        std::size_t field       = 0;                                                // 1-based column to convert; 0 converts whole lines
+        bool        header      = false;                                            // copy the first line of the first input unchanged
+        bool        quiet       = false;
+        unsigned    threads     = 1;
+        const char* reject_path = nullptr;
+    };
+
+    /**
+     * @brief  a row left out of the output
+     */
+    struct reject{
+        std::size_t         line;                                                   // line number within its chunk, from 0
+        std::string_view    row;                                                    // the row as read, without its line terminator
+        const char*         reason;
+    };
+
+    /**
+     * @brief  one line-aligned piece of input and its converted output
+     */
+    struct chunk{
+        const char*         begin = nullptr;
+        const char*         end   = nullptr;
+        std::string         out;
+        std::vector<reject> rejects;
+        std::size_t         lines = 0;
+    };
+
+    /**
+     * @brief  fixed set of threads that run numbered tasks; the calling thread takes part
+     */
+    class task_pool{
+    public:
+        explicit task_pool(unsigned threads){
+            for(unsigned t = 1; t < threads; t++){
+                workers.emplace_back([this]{ work(); });
+            }
+        }
+
+        ~task_pool(){
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for(std::thread& worker : workers){
+                worker.join();
+            }
+        }
+
+        /**
+         * @brief  run `task(0)` ... `task(count - 1)` and return when all have finished
+         */
+        void run(std::size_t count, const std::function<void(std::size_t)>& task){
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                idle.wait(guard, [this]{ return busy == 0; });                      // no worker may still be draining the last run
+                current  = &task;
+                total    = count;
+                finished = 0;
+                next     = 0;
+                generation++;
+            }
+            wake.notify_all();
+            drain();
+            std::unique_lock<std::mutex> guard(lock);
+            idle.wait(guard, [this]{ return finished == total; });
+        }
+
+    private:
+        void work(){
+            unsigned long seen = 0;
+            std::unique_lock<std::mutex> guard(lock);
+            while(true){
+                wake.wait(guard, [&]{ return stopping || generation != seen; });
+                if(stopping){
+                    return;
+                }
+                seen = generation;
+                busy++;
+                guard.unlock();
+                drain();
+                guard.lock();
+                busy--;
+                idle.notify_all();
+            }
+        }
+
+        void drain(){
+            std::size_t done = 0;
+            for(std::size_t i = next++; i < total; i = next++){
+                (*current)(i);
+                done++;
+            }
+            if(done > 0){
+                std::lock_guard<std::mutex> guard(lock);
+                finished += done;
+                idle.notify_all();
+            }
+        }
+
+        std::vector<std::thread>                    workers;
+        std::mutex                                  lock;
+        std::condition_variable                     wake, idle;
+        const std::function<void(std::size_t)>*     current    = nullptr;
+        std::size_t                                 total      = 0;
+        std::size_t                                 finished   = 0;
+        std::atomic<std::size_t>                    next{0};
+        unsigned long                               generation = 0;
+        unsigned                                    busy       = 0;
+        bool                                        stopping   = false;
+    };
+
+    /**
+     * @brief  convert one field; returns nullptr on success or the reason it was rejected
+     */
+    const char* convert_field(std::string_view field, bool decode, bool checked, std::string& out){
+        char text[std::numeric_limits<long int>::digits10 + 2];
+        if(decode){
+            long int serial = 0;
+            switch(checked ? tag_try_decode_checked(field, serial) : tag_try_decode(field, serial)){
+                case tag_decode_status::ok:
+                    break;
+                case tag_decode_status::blank:
+                    return "blank tag";
+                case tag_decode_status::overflow:
+                    return "tag too large";
+                case tag_decode_status::non_canonical:
+                    return "leading zero digit";
+                case tag_decode_status::bad_check:
+                    return "check character mismatch";
+                default:
+                    return "invalid character";
+            }
+            out.append(text, std::to_chars(text, text + sizeof(text), serial).ptr);
+            return nullptr;
+        }
+        long int serial = 0;
+        auto     parsed = std::from_chars(field.data(), field.data() + field.size(), serial);
+        if(parsed.ec == std::errc::result_out_of_range){
+            return "serial number too large";
+        }
+        if(parsed.ec != std::errc() || parsed.ptr != field.data() + field.size()){
+            return "not a serial number";
+        }
+        if(serial < 0){
+            return "negative serial number";
+        }
+        std::size_t width  = checked ? TAG_MAX_LENGTH_CHECKED : TAG_MAX_LENGTH;
+        std::size_t length = checked ? tag_encode_checked(serial, text, width)      // right-aligned in the first `width` bytes
+                                     : tag_encode(serial, text, width);
+        out.append(text + width - length, length);
+        return nullptr;
+    }
+
+    /**
+     * @brief  convert every line of a chunk into its output buffer
+     */
+    void convert_chunk(chunk& piece, const options& settings){
+        piece.out.clear();
+        piece.rejects.clear();
+        piece.lines = 0;
+        for(const char* line = piece.begin; line < piece.end; piece.lines++){
+            const char* newline = static_cast<const char*>(std::memchr(line, '\n', piece.end - line));
+            const char* next    = newline ? newline + 1 : piece.end;
+            const char* row_end = newline ? newline : piece.end;
+            if(row_end > line && row_end[-1] == '\r'){
+                row_end--;                                                          // keep CRLF input intact
+            }
+            const char* field_begin = line;
+            const char* field_end   = row_end;
+            const char* reason      = nullptr;
+            for(std::size_t column = 1; column < settings.field && field_begin; column++){
+                const char* delimiter = static_cast<const char*>(std::memchr(field_begin, settings.delimiter, row_end - field_begin));
+                field_begin = delimiter ? delimiter + 1 : nullptr;
+            }
+            if(!field_begin){
+                reason = "missing field";
+            }else{
+                if(settings.field > 0){
+                    const char* delimiter = static_cast<const char*>(std::memchr(field_begin, settings.delimiter, row_end - field_begin));
+                    field_end = delimiter ? delimiter : row_end;
+                }
+                std::size_t rollback = piece.out.size();
+                piece.out.append(line, field_begin);
+                reason = convert_field(std::string_view(field_begin, field_end - field_begin), settings.decode, settings.checked, piece.out);
+                if(reason){
+                    piece.out.resize(rollback);
+                }else{
+                    piece.out.append(field_end, next);
+                }
+            }
+            if(reason){
+                piece.rejects.push_back({piece.lines, std::string_view(line, row_end - line), reason});
+            }
+            line = next;
+        }
+    }
+
+    /**
+     * @brief  converts inputs chunk by chunk and writes the results in order
+     */
+    class converter{
+    public:
+        converter(const options& settings, FILE* rejects)
+            : settings(settings), reject_stream(rejects), pool(settings.threads),
+              chunks(settings.threads * CHUNKS_PER_THREAD){
+            for(chunk& piece : chunks){
+                piece.out.reserve(CHUNK_SIZE + CHUNK_SIZE / 2);
+            }
+        }
+
+        /**
+         * @brief  convert the complete lines of `data`; the last line is complete only if `final`
+         *
+         * @return  number of bytes consumed
+         */
+        std::size_t convert(const char* name, const char* data, std::size_t size, bool final){
+            const char* pos = data;
+            const char* end = data + size;
+            if(header_pending){
+                const char* newline = static_cast<const char*>(std::memchr(pos, '\n', size));
+                if(!newline && !final){
+                    return 0;
+                }
+                const char* next = newline ? newline + 1 : end;
+                write(pos, next - pos);
+                header_pending = false;
+                line_number++;
+                pos = next;
+            }
+            while(pos < end){
+                std::size_t count = 0;
+                while(count < chunks.size() && pos < end){
+                    const char* stop = (static_cast<std::size_t>(end - pos) > CHUNK_SIZE) ? pos + CHUNK_SIZE : end;
+                    if(stop < end){
+                        const char* newline = static_cast<const char*>(std::memchr(stop, '\n', end - stop));
+                        stop = newline ? newline + 1 : end;
+                    }
+                    if(stop == end && !final && end[-1] != '\n'){                   // keep a partial last line for the next block
+                        const char* newline = static_cast<const char*>(memrchr(pos, '\n', end - pos));
+                        if(!newline){
+                            break;
+                        }
+                        stop = newline + 1;
+                    }
+                    chunks[count].begin = pos;
+                    chunks[count].end   = stop;
+                    count++;
+                    pos = stop;
+                    if(stop != end && !final && static_cast<std::size_t>(end - stop) < CHUNK_SIZE){
+                        break;                                                      // read more before starting a small tail
+                    }
+                }
+                if(count == 0){
+                    break;
+                }
+                pool.run(count, task);
+                for(std::size_t c = 0; c < count; c++){
+                    flush(name, chunks[c]);
+                }
+                if(!final && static_cast<std::size_t>(end - pos) < CHUNK_SIZE){
+                    break;
+                }
+            }
+            bytes_in += pos - data;
+            return pos - data;
+        }
+
+        /**
+         * @brief  start numbering lines again for the next input
+         */
+        void next_input(){
+            line_number = 0;
+        }
+
+        bool output_failed() const{
+            return write_failed;
+        }
+
+        std::size_t rows = 0, rejected = 0, bytes_in = 0, bytes_out = 0;
+
+    private:
+        void write(const char* data, std::size_t size){
+            if(size > 0 && std::fwrite(data, 1, size, stdout) != size){
+                write_failed = true;
+            }
+            bytes_out += size;
+        }
+
+        void flush(const char* name, const chunk& piece){
+            write(piece.out.data(), piece.out.size());
+            for(const reject& row : piece.rejects){
+                std::fprintf(reject_stream, "%s:%zu: %s: %.*s\n", name, line_number + row.line + 1,
+                             row.reason, static_cast<int>(row.row.size()), row.row.data());
+            }
+            rows        += piece.lines;
+            rejected    += piece.rejects.size();
+            line_number += piece.lines;
+        }
+
+        const options&                          settings;
+        FILE*                                   reject_stream;
+        task_pool                               pool;
+        std::vector<chunk>                      chunks;
+        std::function<void(std::size_t)>        task = [this](std::size_t c){ convert_chunk(chunks[c], settings); };
+        std::size_t                             line_number    = 0;
+        bool                                    header_pending = settings.header;
+        bool                                    write_failed   = false;
+    };
+
+    /**
+     * @brief  convert a file through a read-only memory map, or by reading it if it cannot be mapped
+     */
+    bool convert_file(converter& conversion, const char* path, int fd){
+        struct stat info;
+        if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0){
+            void* map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(map != MAP_FAILED){
+                madvise(map, info.st_size, MADV_SEQUENTIAL);
+                conversion.convert(path, static_cast<const char*>(map), info.st_size, true);
+                munmap(map, info.st_size);
+                return true;
+            }
+        }
+        std::vector<char> block(CHUNK_SIZE * CHUNKS_PER_THREAD * 2);              // pipes, terminals and empty files
+        std::size_t       held = 0;
+        bool              eof  = false;
+        while(!eof){
+            if(held == block.size()){
+                block.resize(block.size() * 2);                                     // a single line longer than the block
+            }
+            while(held < block.size()){                                             // fill the block: pipes return short reads
+                ssize_t got = read(fd, block.data() + held, block.size() - held);
+                if(got < 0 && errno == EINTR){
+                    continue;
+                }
+                if(got < 0){
+                    std::fprintf(stderr, "tag_encode: %s: %s\n", path, std::strerror(errno));
+                    return false;
+                }
+                if(got == 0){
+                    eof = true;
+                    break;
+                }
+                held += got;
+            }
+            std::size_t used = conversion.convert(path, block.data(), held, eof);
+            std::memmove(block.data(), block.data() + used, held - used);
+            held -= used;
+        }
+        return true;
+    }
+
+    /**
+     * @brief  parse a whole option argument as a non-negative number; false if any of it is not one
+     */
+    template<typename Number>
+    bool parse_number(const char* text, Number& number){
+        const char* end    = text + std::strlen(text);
+        auto        parsed = std::from_chars(text, end, number);
+        return parsed.ec == std::errc() && parsed.ptr == end;
+    }
+
+    void usage(){
+        std::fprintf(stderr,
+            "usage: tag_encode [-d] [-c] [-t delim] [-f field] [-H] [-j threads] [-r rejects] [-q] [file...]\n"
+            "  -d          decode tags to serial numbers (default: encode serial numbers)\n"
+            "  -c          tags end in a check character (see tag_encode_checked)\n"
+            "  -f field    convert only this 1-based column of each line\n"
+            "  -t delim    column delimiter for -f (default ',')\n"
+            "  -H          copy the first line (a header) unchanged\n"
+            "  -j threads  worker threads (default: all cores)\n"
+            "  -r rejects  write rejected rows to this file (default: standard error)\n"
+            "  -q          do not print throughput counters\n");
+    }
+}
+
+int main(int argc, char* argv[]){
+    options settings;
+    settings.threads = std::max(1u, std::thread::hardware_concurrency());
+    int  opt;
+    bool valid = true;
+    while((opt = getopt(argc, argv, "dcf:t:Hj:r:q")) != -1){
+        switch(opt){
+            case 'd': settings.decode      = true;                                         break;
+            case 'c': settings.checked     = true;                                         break;
+            case 'f': valid = parse_number(optarg, settings.field) && settings.field > 0;  break;
+            case 't': valid = optarg[0] != '\0' && optarg[1] == '\0';
+                      settings.delimiter   = optarg[0];                                    break;
+            case 'H': settings.header      = true;                                         break;
+            case 'j': valid = parse_number(optarg, settings.threads);
+                      settings.threads     = std::max(1u, settings.threads);               break;
+            case 'r': settings.reject_path = optarg;                                       break;
+            case 'q': settings.quiet       = true;                                         break;
+            default:  usage();                                                             return 2;
+        }
+        if(!valid){
+            usage();
+            return 2;
+        }
+    }
+    if(settings.delimiter == '\n' || settings.delimiter == '\0'){
+        usage();
+        return 2;
+    }
+    FILE* rejects = stderr;
+    if(settings.reject_path && !(rejects = std::fopen(settings.reject_path, "w"))){
+        std::fprintf(stderr, "tag_encode: %s: %s\n", settings.reject_path, std::strerror(errno));
+        return 1;
+    }
+    std::setvbuf(stdout, nullptr, _IOFBF, 1 << 20);
+
+    auto      start = std::chrono::steady_clock::now();
+    bool      ok    = true;
+    converter conversion(settings, rejects);
+    if(optind == argc){
+        ok = convert_file(conversion, "-", STDIN_FILENO);
+    }
+    for(int arg = optind; arg < argc; arg++){
+        int fd = std::strcmp(argv[arg], "-") == 0 ? STDIN_FILENO : open(argv[arg], O_RDONLY);
+        if(fd < 0){
+            std::fprintf(stderr, "tag_encode: %s: %s\n", argv[arg], std::strerror(errno));
+            ok = false;
+            continue;
+        }
+        ok = convert_file(conversion, argv[arg], fd) && ok;
+        conversion.next_input();
+        if(fd != STDIN_FILENO){
+            close(fd);
+        }
+    }
+    if(std::fflush(stdout) != 0 || conversion.output_failed()){
+        std::fprintf(stderr, "tag_encode: write error: %s\n", std::strerror(errno));
+        ok = false;
+    }
+    if(rejects != stderr){
+        std::fclose(rejects);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(!settings.quiet){
+        std::fprintf(stderr, "tag_encode: %zu rows, %zu rejected, %.1f MB in, %.1f MB out, %.3f s, %.1f MB/s, %.1f M rows/s\n",
+                     conversion.rows, conversion.rejected, conversion.bytes_in / 1e6, conversion.bytes_out / 1e6, seconds,
+                     seconds > 0 ? conversion.bytes_in / 1e6 / seconds : 0.0, seconds > 0 ? conversion.rows / 1e6 / seconds : 0.0);
+    }
+    return ok ? 0 : 1;
+}
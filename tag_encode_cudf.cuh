@@ -0,0 +1,272 @@
+/**
+ * @file tag_encode_cudf.cuh
+ *
+ * GPU (CUDA) bulk conversion for RAPIDS cuDF columns: `tag_encode_cudf()`
+ * turns an `INT64` column of serial numbers into a `STRING` column of tags,
+ * and `tag_decode_cudf()` turns a `STRING` column back into `INT64`, without
+ * the data leaving device memory.
+ *
+ *  - One thread per row.  The group table, length thresholds and decode
+ *    table of "tag_encode.h" are copied into constant memory at compile
+ *    time, and the device code runs the same group-at-a-time algorithm as
+ *    `tag_encode()` and `tag_try_decode()`, so every tag is byte-identical to
+ *    the CPU result.
+ *  - Encoding takes two passes, like `tag_column_offsets()` and
+ *    `tag_encode_column()`: the lengths are scanned into the strings
+ *    column's offsets, then each thread writes its tag backwards from the
+ *    end of its slot.  Null serials give null tags; a negative serial throws
+ *    `std::out_of_range`.
+ *  - Decoding gives a null serial for a null or invalid tag (anything
+ *    `tag_try_decode()` refuses), so bad rows never stop a job.
+ *
+ * Requires CUDA 11 or later and cuDF 24.08 or later (string columns built
+ * from a character buffer and 32-bit offsets).  Include it from `.cu` files,
+ * which nvcc compiles with the CPU dispatch of "tag_encode.h" turned off.
+ *
+ * Build:
+ *     nvcc -std=c++17 -O2 -arch=native program.cu -lcudf
+ *
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef TAG_ENCODE_CUDF_CUH
+#define TAG_ENCODE_CUDF_CUH
+
+#include<cstdint>
+#include<limits>
+#include<memory>
+#include<stdexcept>
+
+#include<cudf/column/column.hpp>
+#include<cudf/column/column_device_view.cuh>
+#include<cudf/column/column_factories.hpp>
+#include<cudf/null_mask.hpp>
+#include<cudf/strings/string_view.cuh>
+#include<cudf/transform.hpp>
+#include<cudf/utilities/default_stream.hpp>
+#include<cudf/utilities/error.hpp>
+#include<rmm/cuda_stream_view.hpp>
+#include<rmm/device_buffer.hpp>
+#include<rmm/device_scalar.hpp>
+#include<rmm/exec_policy.hpp>
+#include<rmm/mr/device/per_device_resource.hpp>
+#include<rmm/resource_ref.hpp>
+#include<thrust/reduce.h>
+#include<thrust/scan.h>
+
+#include "tag_encode.h"
+
+namespace tag_encode_cudf_detail{
+    /*
+     * Device copies of the host tables, constant-initialized so that no
+     * upload is needed on any device.  Each translation unit has its own.
+     */
+    static __constant__ tag_encode_detail::group_table  GROUPS  = tag_encode_detail::GROUPS;
+    static __constant__ tag_encode_detail::length_table LENGTHS = tag_encode_detail::LENGTHS;
+    static __constant__ tag_encode_detail::decode_table DIGITS  = tag_encode_detail::DIGITS;
+
+    constexpr int BLOCK_SIZE = 256;
+
+    /**
+     * @brief  `tag_encoded_length()` on the device
+     */
+    __device__ inline int encoded_length(unsigned long int value){
+        int width  = value == 0 ? 0 : 64 - __clzll(value);
+        int length = LENGTHS.by_width[width];
+        return length + (value >= LENGTHS.limit[length - 1] ? 1 : 0);
+    }
+
+    /**
+     * @brief  `tag_encode_detail::encode_unsigned()` on the device: one division per group, backwards from `tag_end`
+     */
+    __device__ inline void encode_serial(unsigned long int value, char* tag_end){
+        while(value >= tag_encode_detail::GROUP_BASE){
+            const char* group = GROUPS.triplet[value % tag_encode_detail::GROUP_BASE];
+            tag_end   -= 3;
+            tag_end[0] = group[0];
+            tag_end[1] = group[1];
+            tag_end[2] = group[2];
+            value     /= tag_encode_detail::GROUP_BASE;
+        }
+        int length = value < N_ALPHANUM ? 1 : (value < N_ALPHANUM * N_ALPHACASE ? 2 : 3);
+        for(int i = 0; i < length; i++){                                            // leading group without its zero padding
+            tag_end[i - length] = GROUPS.triplet[value][3 - length + i];
+        }
+    }
+
+    /**
+     * @brief  `tag_try_decode()` on the device; true if the tag is valid
+     */
+    __device__ inline bool decode_serial(const char* tag, int tag_size, std::int64_t& serial){
+        if(tag_size < 1 || tag_size > TAG_MAX_LENGTH){
+            return false;
+        }
+        unsigned long long value = 0;
+        int                k     = (tag_size - 1) % 3;                              // position class of the leading character
+        for(int i = 0; i < tag_size; i++, k = (k == 0) ? 2 : k - 1){
+            int digit = DIGITS.value[k][static_cast<unsigned char>(tag[i])];
+            if(digit == tag_encode_detail::INVALID_DIGIT || (i == 0 && digit == 0 && tag_size > 1)){
+                return false;                                                       // wrong class, or a leading zero digit
+            }
+            value = value * (k == 0 ? N_ALPHANUM : (k == 1 ? N_ALPHACASE : N_DIGITS)) + digit;   // BASE_SELECT[k]
+        }
+        if(value > static_cast<unsigned long long>(INT64_MAX)){
+            return false;
+        }
+        serial = static_cast<std::int64_t>(value);
+        return true;
+    }
+
+    /**
+     * @brief  first pass of the encoder: the tag length of every row (0 for nulls)
+     */
+    static __global__ void length_kernel(cudf::column_device_view serials, cudf::size_type* sizes, int* negative){
+        std::int64_t i = static_cast<std::int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+        if(i >= serials.size()){
+            return;
+        }
+        cudf::size_type size = 0;
+        if(serials.is_valid(i)){
+            std::int64_t serial = serials.element<std::int64_t>(i);
+            if(serial < 0){
+                *negative = 1;
+            }else{
+                size = encoded_length(serial);
+            }
+        }
+        sizes[i] = size;
+    }
+
+    /**
+     * @brief  second pass of the encoder: each row's tag, right-aligned in its slot
+     */
+    static __global__ void encode_kernel(cudf::column_device_view serials, const cudf::size_type* offsets, char* chars){
+        std::int64_t i = static_cast<std::int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+        if(i >= serials.size() || offsets[i + 1] == offsets[i]){
+            return;                                                                 // null rows are empty strings
+        }
+        encode_serial(serials.element<std::int64_t>(i), chars + offsets[i + 1]);
+    }
+
+    /**
+     * @brief  the decoder: a serial number and a validity flag per row
+     */
+    static __global__ void decode_kernel(cudf::column_device_view tags, std::int64_t* serials, bool* valid){
+        std::int64_t i = static_cast<std::int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+        if(i >= tags.size()){
+            return;
+        }
+        std::int64_t serial = 0;
+        bool         ok     = false;
+        if(tags.is_valid(i)){
+            cudf::string_view tag = tags.element<cudf::string_view>(i);
+            ok = decode_serial(tag.data(), tag.size_bytes(), serial);
+        }
+        serials[i] = ok ? serial : 0;
+        valid[i]   = ok;
+    }
+
+    inline unsigned int blocks_for(cudf::size_type rows){
+        return static_cast<unsigned int>((static_cast<std::int64_t>(rows) + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    }
+}
+
+/**
+ * @brief  encode an `INT64` column of serial numbers into a `STRING` column of tags on the GPU
+ *
+ * @throw  cudf::logic_error    thrown if `serials` is not an `INT64` column
+ * @throw  std::out_of_range    thrown if a (non-null) serial number is negative
+ * @throw  std::length_error    thrown if the tags exceed the 32-bit offsets of a strings column
+ *
+ * @param  serials  serial numbers; null rows give null tags
+ * @param  stream   CUDA stream for the kernels and allocations
+ * @param  mr       device memory resource for the result
+ * @return          strings column of `serials.size()` tags, identical to `tag_encode()`
+ */
+inline std::unique_ptr<cudf::column> tag_encode_cudf(cudf::column_view const& serials,
+                                                     rmm::cuda_stream_view stream = cudf::get_default_stream(),
+                                                     rmm::device_async_resource_ref mr = rmm::mr::get_current_device_resource()){
+    using namespace tag_encode_cudf_detail;
+    CUDF_EXPECTS(serials.type().id() == cudf::type_id::INT64, "tag_encode_cudf: serial numbers must be an INT64 column");
+    cudf::size_type rows    = serials.size();
+    auto            offsets = cudf::make_numeric_column(cudf::data_type{cudf::type_id::INT32}, rows + 1, cudf::mask_state::UNALLOCATED, stream, mr);
+    auto*           ends    = offsets->mutable_view().data<cudf::size_type>();
+    if(rows == 0){
+        CUDF_CUDA_TRY(cudaMemsetAsync(ends, 0, sizeof(cudf::size_type), stream.value()));
+        return cudf::make_strings_column(0, std::move(offsets), rmm::device_buffer(0, stream, mr), 0, rmm::device_buffer(0, stream, mr));
+    }
+
+    auto                    device_serials = cudf::column_device_view::create(serials, stream);
+    rmm::device_scalar<int> negative(0, stream);
+    length_kernel<<<blocks_for(rows), BLOCK_SIZE, 0, stream.value()>>>(*device_serials, ends, negative.data());
+    CUDF_CUDA_TRY(cudaGetLastError());
+    std::int64_t total = thrust::reduce(rmm::exec_policy(stream), ends, ends + rows, std::int64_t(0));
+    if(negative.value(stream) != 0){
+        throw std::out_of_range("tag_encode_cudf: serial numbers must be non-negative");
+    }
+    if(total > std::numeric_limits<cudf::size_type>::max()){
+        throw std::length_error("tag_encode_cudf: tags exceed the 32-bit offsets of a strings column");
+    }
+    CUDF_CUDA_TRY(cudaMemsetAsync(ends + rows, 0, sizeof(cudf::size_type), stream.value()));
+    thrust::exclusive_scan(rmm::exec_policy(stream), ends, ends + rows + 1, ends);     // lengths -> offsets, in place
+
+    rmm::device_buffer chars(total, stream, mr);
+    encode_kernel<<<blocks_for(rows), BLOCK_SIZE, 0, stream.value()>>>(*device_serials, ends, static_cast<char*>(chars.data()));
+    CUDF_CUDA_TRY(cudaGetLastError());
+    return cudf::make_strings_column(rows, std::move(offsets), std::move(chars), serials.null_count(),
+                                     cudf::copy_bitmask(serials, stream, mr));
+}
+
+/**
+ * @brief  decode a `STRING` column of tags into an `INT64` column of serial numbers on the GPU
+ *
+ * Upper-case letters and the digits '0' and '1' are accepted exactly as
+ * `tag_try_decode()` accepts them.
+ *
+ * @throw  cudf::logic_error    thrown if `tags` is not a `STRING` column
+ *
+ * @param  tags     tags; null and invalid rows give null serial numbers
+ * @param  stream   CUDA stream for the kernels and allocations
+ * @param  mr       device memory resource for the result
+ * @return          `INT64` column of `tags.size()` serial numbers
+ */
+inline std::unique_ptr<cudf::column> tag_decode_cudf(cudf::column_view const& tags,
+                                                     rmm::cuda_stream_view stream = cudf::get_default_stream(),
+                                                     rmm::device_async_resource_ref mr = rmm::mr::get_current_device_resource()){
+    using namespace tag_encode_cudf_detail;
+    CUDF_EXPECTS(tags.type().id() == cudf::type_id::STRING, "tag_decode_cudf: tags must be a STRING column");
+    cudf::size_type rows    = tags.size();
+    auto            serials = cudf::make_numeric_column(cudf::data_type{cudf::type_id::INT64}, rows, cudf::mask_state::UNALLOCATED, stream, mr);
+    if(rows == 0){
+        return serials;
+    }
+    auto valid       = cudf::make_numeric_column(cudf::data_type{cudf::type_id::BOOL8}, rows, cudf::mask_state::UNALLOCATED, stream);
+    auto device_tags = cudf::column_device_view::create(tags, stream);
+    decode_kernel<<<blocks_for(rows), BLOCK_SIZE, 0, stream.value()>>>(*device_tags, serials->mutable_view().data<std::int64_t>(),
+                                                                       valid->mutable_view().data<bool>());
+    CUDF_CUDA_TRY(cudaGetLastError());
+    auto mask = cudf::bools_to_mask(valid->view(), stream, mr);                     // rows that decoded; null rows never do
+    serials->set_null_mask(std::move(*mask.first), mask.second);
+    return serials;
+}
+
+#endif
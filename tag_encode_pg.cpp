@@ -0,0 +1,91 @@
+/**
+ * @file tag_encode_pg.cpp
+ *
+ * PostgreSQL extension providing the SQL functions `tag_encode(bigint)` and
+ * `tag_decode(text)` in C, so rows can be fetched by tag without decoding
+ * in the application:
+ *
+ *     CREATE EXTENSION tag_encode;
+ *     SELECT * FROM orders WHERE id = tag_decode($1);
+ *     CREATE INDEX orders_by_tag ON orders (tag_encode(id));
+ *
+ * Both functions are declared IMMUTABLE, STRICT and PARALLEL SAFE (see
+ * tag_encode--1.0.sql), so the planner folds a call on a constant or
+ * parameter into an index condition, and expression indexes on tags are
+ * allowed.
+ *
+ *  - `tag_encode(bigint)` returns the tag as text; a negative serial number
+ *    raises `numeric_value_out_of_range`.
+ *  - `tag_decode(text)` returns the serial number; an invalid tag (anything
+ *    `tag_try_decode()` refuses) gives NULL, so a query never fails on a bad
+ *    tag.  NULL arguments give NULL.
+ *
+ * Only the non-throwing paths of "tag_encode.h" are called: PostgreSQL
+ * reports errors with longjmp, which C++ exceptions must never cross.
+ *
+ * Build and install (PostgreSQL 12 or later, server headers required):
+ *     g++ -std=c++17 -O2 -fPIC -shared -I"$(pg_config --includedir-server)" -o tag_encode.so tag_encode_pg.cpp
+ *     cp tag_encode.so "$(pg_config --pkglibdir)"
+ *     cp tag_encode.control tag_encode--1.0.sql "$(pg_config --sharedir)/extension"
+ *
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "tag_encode.h"
+
+extern "C"{
+#include "postgres.h"
+#include "fmgr.h"
+#include "utils/builtins.h"
+
+PG_MODULE_MAGIC;
+
+PG_FUNCTION_INFO_V1(pg_tag_encode);
+PG_FUNCTION_INFO_V1(pg_tag_decode);
+
+/**
+ * @brief  `tag_encode(bigint) RETURNS text`
+ */
+Datum pg_tag_encode(PG_FUNCTION_ARGS){
+    int64 serial = PG_GETARG_INT64(0);
+    if(serial < 0){
+        ereport(ERROR, (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+                        errmsg("tag_encode: serial number must be non-negative")));
+    }
+    char        tag[TAG_MAX_LENGTH];
+    std::size_t length = tag_encode(serial, tag, TAG_MAX_LENGTH);                    // right-aligned; cannot throw here
+    PG_RETURN_TEXT_P(cstring_to_text_with_len(tag + TAG_MAX_LENGTH - length, length));
+}
+
+/**
+ * @brief  `tag_decode(text) RETURNS bigint`, NULL for an invalid tag
+ */
+Datum pg_tag_decode(PG_FUNCTION_ARGS){
+    text*    tag    = PG_GETARG_TEXT_PP(0);
+    long int serial = 0;
+    if(tag_try_decode(std::string_view(VARDATA_ANY(tag), VARSIZE_ANY_EXHDR(tag)), serial) != tag_decode_status::ok){
+        PG_RETURN_NULL();
+    }
+    PG_RETURN_INT64(serial);
+}
+}
@@ -0,0 +1,461 @@
+/**
+ * @file tag_encode_python.cpp
+ *
+ * Python extension module `tag_encode`, written against the CPython C API
+ * and the buffer protocol so that it needs no binding library and no NumPy
+ * at build time.  Arrays are read in place from anything that exports a
+ * contiguous one-dimensional buffer (NumPy arrays, `array.array`,
+ * `memoryview`, Arrow buffers), and results are returned as buffer objects
+ * that NumPy and Arrow wrap without copying:
+ *
+ *     import numpy as np, pyarrow as pa, tag_encode
+ *     tags  = np.asarray(tag_encode.encode_batch(ids))            # dtype S16, one NUL-padded tag per row
+ *     values, valid = map(np.asarray, tag_encode.decode_batch(tags))  # int64 array and bool mask
+ *     offsets, data = tag_encode.encode_arrow(ids)                # Arrow string layout
+ *     column = pa.StringArray.from_buffers(len(ids), pa.py_buffer(offsets), pa.py_buffer(data))
+ *
+ *  - `encode(serial)` / `decode(tag)`: single tags, as `tag_encode()` and
+ *    `tag_decode()`; errors raise `ValueError`.
+ *  - `encode_batch(serials, threads=0)`: `int64` serials through the SIMD
+ *    batch kernels, or `uint64` serials through `tag_encode_u64()`, into
+ *    16-byte slots (format `16s`).  A negative serial raises `ValueError`.
+ *  - `decode_batch(tags, threads=0, unsigned=False)`: fixed-width byte
+ *    strings (format `Ns`, N up to 16; e.g. NumPy `S16`) to a values array
+ *    (`int64`, or `uint64` if `unsigned`) and a `bool` mask that is False for
+ *    each invalid tag, whose value is 0.  Invalid tags never raise.
+ *  - `encode_arrow(serials, threads=0)` and `decode_arrow(data, offsets,
+ *    threads=0)`: the same over Arrow's 32-bit offsets and character data.
+ *
+ * The batch functions release the GIL and split arrays of more than
+ * `PARALLEL_MIN` rows across `threads` threads (0: one per hardware thread).
+ *
+ * Build:
+ *     g++ -std=c++17 -O2 -shared -fPIC -pthread $(python3-config --includes) \
+ *         -o tag_encode$(python3-config --extension-suffix) tag_encode_python.cpp
+ *
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include<Python.h>
+
+#include<cstdlib>
+#include<cstring>
+#include<algorithm>
+#include<thread>
+#include<vector>
+
+#include "tag_encode.h"
+
+namespace{
+    constexpr std::size_t PARALLEL_MIN = 1 << 16;                                   // rows below which one thread does the work
+
+    /**
+     * @brief  a result array: a malloc'd block exported through the buffer protocol as `shape[0]` items of `format`
+     */
+    struct buffer_object{
+        PyObject_HEAD
+        char*       data;
+        Py_ssize_t  shape[1];
+        Py_ssize_t  strides[1];
+        char        format[8];
+    };
+
+    void buffer_dealloc(PyObject* self){
+        std::free(reinterpret_cast<buffer_object*>(self)->data);
+        Py_TYPE(self)->tp_free(self);
+    }
+
+    int buffer_get(PyObject* self, Py_buffer* view, int flags){
+        buffer_object* buffer = reinterpret_cast<buffer_object*>(self);
+        view->obj        = Py_NewRef(self);
+        view->buf        = buffer->data;
+        view->itemsize   = buffer->strides[0];
+        view->len        = buffer->shape[0] * buffer->strides[0];
+        view->readonly   = 0;
+        view->ndim       = 1;
+        view->format     = (flags & PyBUF_FORMAT) ? buffer->format : nullptr;
+        view->shape      = (flags & PyBUF_ND) ? buffer->shape : nullptr;
+        view->strides    = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? buffer->strides : nullptr;
+        view->suboffsets = nullptr;
+        view->internal   = nullptr;
+        return 0;
+    }
+
+    Py_ssize_t buffer_length(PyObject* self){
+        return reinterpret_cast<buffer_object*>(self)->shape[0];
+    }
+
+    PyBufferProcs   buffer_procs    = {buffer_get, nullptr};
+    PySequenceMethods buffer_sequence = {buffer_length};
+
+    PyTypeObject buffer_type = [](){
+        PyTypeObject type{PyVarObject_HEAD_INIT(nullptr, 0)};
+        type.tp_name        = "tag_encode.Buffer";
+        type.tp_basicsize   = sizeof(buffer_object);
+        type.tp_dealloc     = buffer_dealloc;
+        type.tp_as_sequence = &buffer_sequence;
+        type.tp_as_buffer   = &buffer_procs;
+        type.tp_flags       = Py_TPFLAGS_DEFAULT;
+        type.tp_doc         = "Result array of tag_encode; wrap it with numpy.asarray() or pyarrow.py_buffer().";
+        return type;
+    }();
+
+    /**
+     * @brief  a new zero-filled result of `n` items of `itemsize` bytes, or nullptr with MemoryError set
+     */
+    buffer_object* new_buffer(Py_ssize_t n, Py_ssize_t itemsize, const char* format){
+        buffer_object* buffer = PyObject_New(buffer_object, &buffer_type);
+        if(buffer == nullptr){
+            return nullptr;
+        }
+        buffer->data       = static_cast<char*>(std::calloc(std::max<Py_ssize_t>(n * itemsize, 1), 1));
+        buffer->shape[0]   = n;
+        buffer->strides[0] = itemsize;
+        std::snprintf(buffer->format, sizeof(buffer->format), "%s", format);
+        if(buffer->data == nullptr){
+            Py_DECREF(buffer);
+            PyErr_NoMemory();
+            return nullptr;
+        }
+        return buffer;
+    }
+
+    /**
+     * @brief  a contiguous one-dimensional input buffer, released on scope exit
+     */
+    struct input_view{
+        Py_buffer view{};
+        bool      held = false;
+
+        ~input_view(){
+            if(held){
+                PyBuffer_Release(&view);
+            }
+        }
+
+        /**
+         * @brief  acquire `object`'s buffer; false with an exception set if it is not a 1-D contiguous array
+         */
+        bool acquire(PyObject* object, const char* name){
+            if(PyObject_GetBuffer(object, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0){
+                return false;
+            }
+            held = true;
+            if(view.ndim != 1){
+                PyErr_Format(PyExc_ValueError, "%s must be a one-dimensional array", name);
+                return false;
+            }
+            return true;
+        }
+
+        Py_ssize_t size() const{
+            return view.shape[0];
+        }
+
+        /**
+         * @brief  the struct-module type character of the items, without a native byte-order prefix
+         */
+        char type() const{
+            const char* format = view.format ? view.format : "B";
+            if(*format == '@' || *format == '=' || *format == '<'){                 // little-endian hosts only, as the kernels
+                format++;
+            }
+            return format[std::strspn(format, "0123456789")];
+        }
+    };
+
+    /**
+     * @brief  run `body(begin, end)` over `[0, n)`, in parallel chunks for large arrays, with the GIL released
+     */
+    template<typename Body>
+    void parallel_for(std::size_t n, int threads, Body body){
+        Py_BEGIN_ALLOW_THREADS
+        std::size_t workers = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+        workers = std::min(workers, std::max<std::size_t>(1, n / PARALLEL_MIN));
+        std::size_t              chunk = (n + workers - 1) / std::max<std::size_t>(workers, 1);
+        std::vector<std::thread> pool;
+        for(std::size_t begin = chunk; begin < n; begin += chunk){                  // the calling thread takes the first chunk
+            pool.emplace_back(body, begin, std::min(n, begin + chunk));
+        }
+        body(std::size_t(0), std::min(n, chunk));
+        for(std::thread& worker : pool){
+            worker.join();
+        }
+        Py_END_ALLOW_THREADS
+    }
+
+    bool is_int64(const input_view& input){
+        return input.view.itemsize == 8 && (input.type() == 'q' || input.type() == 'l');
+    }
+
+    bool is_uint64(const input_view& input){
+        return input.view.itemsize == 8 && (input.type() == 'Q' || input.type() == 'L');
+    }
+
+    /**
+     * @brief  set ValueError for the first negative serial, if any
+     */
+    bool reject_negative(const std::int64_t* serials, std::size_t n){
+        const std::int64_t* negative = std::find_if(serials, serials + n, [](std::int64_t serial){ return serial < 0; });
+        if(negative != serials + n){
+            PyErr_Format(PyExc_ValueError, "serial number at index %zd is negative", static_cast<Py_ssize_t>(negative - serials));
+            return true;
+        }
+        return false;
+    }
+
+    PyObject* py_encode(PyObject*, PyObject* arg){
+        long long serial = PyLong_AsLongLong(arg);
+        if(serial == -1 && PyErr_Occurred()){
+            return nullptr;
+        }
+        if(serial < 0){
+            PyErr_SetString(PyExc_ValueError, "Serial number must be non-negative.");
+            return nullptr;
+        }
+        char        tag[TAG_MAX_LENGTH];
+        std::size_t length = tag_encode(serial, tag, TAG_MAX_LENGTH);
+        return PyUnicode_FromStringAndSize(tag + TAG_MAX_LENGTH - length, length);
+    }
+
+    PyObject* py_decode(PyObject*, PyObject* arg){
+        Py_ssize_t  size = 0;
+        const char* tag  = PyUnicode_AsUTF8AndSize(arg, &size);
+        if(tag == nullptr){
+            return nullptr;
+        }
+        long int serial = 0;
+        if(tag_try_decode(std::string_view(tag, size), serial) != tag_decode_status::ok){
+            PyErr_Format(PyExc_ValueError, "Invalid input tag: \"%s\"", tag);
+            return nullptr;
+        }
+        return PyLong_FromLong(serial);
+    }
+
+    PyObject* py_encode_batch(PyObject*, PyObject* args, PyObject* kwargs){
+        static const char* keywords[] = {"serials", "threads", nullptr};
+        PyObject*          object     = nullptr;
+        int                threads    = 0;
+        input_view         input;
+        if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", const_cast<char**>(keywords), &object, &threads) ||
+           !input.acquire(object, "serials")){
+            return nullptr;
+        }
+        std::size_t n = input.size();
+        if(is_int64(input)){
+            const std::int64_t* serials = static_cast<const std::int64_t*>(input.view.buf);
+            if(reject_negative(serials, n)){
+                return nullptr;
+            }
+            buffer_object* tags = new_buffer(n, TAG_BATCH_STRIDE, "16s");
+            if(tags == nullptr){
+                return nullptr;
+            }
+            std::vector<std::uint8_t> lengths(n);
+            parallel_for(n, threads, [&](std::size_t begin, std::size_t end){
+                tag_encode_batch(serials + begin, end - begin, tags->data + begin * TAG_BATCH_STRIDE, lengths.data() + begin);
+            });
+            return reinterpret_cast<PyObject*>(tags);
+        }
+        if(is_uint64(input)){
+            const std::uint64_t* serials = static_cast<const std::uint64_t*>(input.view.buf);
+            buffer_object*       tags    = new_buffer(n, TAG_BATCH_STRIDE, "16s");
+            if(tags == nullptr){
+                return nullptr;
+            }
+            parallel_for(n, threads, [&](std::size_t begin, std::size_t end){
+                for(std::size_t i = begin; i < end; i++){                           // left-aligned: encode backwards from the tag's end
+                    tag_encode_detail::encode_unsigned(serials[i], tags->data + i * TAG_BATCH_STRIDE + tag_encoded_length_u64(serials[i]));
+                }
+            });
+            return reinterpret_cast<PyObject*>(tags);
+        }
+        PyErr_SetString(PyExc_TypeError, "serials must be an int64 or uint64 array");
+        return nullptr;
+    }
+
+    PyObject* py_decode_batch(PyObject*, PyObject* args, PyObject* kwargs){
+        static const char* keywords[] = {"tags", "threads", "unsigned", nullptr};
+        PyObject*          object     = nullptr;
+        int                threads    = 0, wide = 0;
+        input_view         input;
+        if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ip", const_cast<char**>(keywords), &object, &threads, &wide) ||
+           !input.acquire(object, "tags")){
+            return nullptr;
+        }
+        std::size_t width = input.view.itemsize, n = input.size();
+        if(input.type() != 's' || width > TAG_BATCH_STRIDE){
+            PyErr_SetString(PyExc_TypeError, "tags must be an array of byte strings of at most 16 bytes (e.g. NumPy S16)");
+            return nullptr;
+        }
+        const char*    tags   = static_cast<const char*>(input.view.buf);
+        buffer_object* values = new_buffer(n, 8, wide ? "Q" : "q");
+        buffer_object* valid  = new_buffer(n, 1, "?");
+        if(values == nullptr || valid == nullptr){
+            Py_XDECREF(values);
+            Py_XDECREF(valid);
+            return nullptr;
+        }
+        parallel_for(n, threads, [&](std::size_t begin, std::size_t end){
+            if(width == TAG_BATCH_STRIDE && !wide){                                 // the SIMD kernel's own layout
+                std::size_t                  count = end - begin;
+                std::vector<std::uint8_t>    bits((count + 7) / 8);
+                std::int64_t*                out   = reinterpret_cast<std::int64_t*>(values->data) + begin;
+                tag_decode_batch(tags + begin * width, count, out, bits.data());
+                for(std::size_t i = 0; i < count; i++){
+                    valid->data[begin + i] = bits[i / 8] >> (i % 8) & 1;
+                }
+                return;
+            }
+            for(std::size_t i = begin; i < end; i++){
+                const char*      slot = tags + i * width;
+                std::string_view tag(slot, std::find(slot, slot + width, '\0') - slot);
+                if(wide){
+                    std::uint64_t serial = 0;
+                    valid->data[i] = tag_try_decode_u64(tag, serial) == tag_decode_status::ok;
+                    reinterpret_cast<std::uint64_t*>(values->data)[i] = valid->data[i] ? serial : 0;
+                }else{
+                    long int serial = 0;
+                    valid->data[i] = tag_try_decode(tag, serial) == tag_decode_status::ok;
+                    reinterpret_cast<std::int64_t*>(values->data)[i] = valid->data[i] ? serial : 0;
+                }
+            }
+        });
+        return Py_BuildValue("(NN)", values, valid);
+    }
+
+    PyObject* py_encode_arrow(PyObject*, PyObject* args, PyObject* kwargs){
+        static const char* keywords[] = {"serials", "threads", nullptr};
+        PyObject*          object     = nullptr;
+        int                threads    = 0;
+        input_view         input;
+        if(!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", const_cast<char**>(keywords), &object, &threads) ||
+           !input.acquire(object, "serials")){
+            return nullptr;
+        }
+        if(!is_int64(input)){
+            PyErr_SetString(PyExc_TypeError, "serials must be an int64 array");
+            return nullptr;
+        }
+        const std::int64_t* serials = static_cast<const std::int64_t*>(input.view.buf);
+        std::size_t         n       = input.size();
+        if(reject_negative(serials, n)){
+            return nullptr;
+        }
+        buffer_object* offsets = new_buffer(n + 1, 4, "i");
+        if(offsets == nullptr){
+            return nullptr;
+        }
+        std::int32_t* ends = reinterpret_cast<std::int32_t*>(offsets->data);
+        try{
+            tag_column_offsets(serials, n, ends);                                   // offsets[0] is already 0
+        }catch(std::length_error&){
+            Py_DECREF(offsets);
+            PyErr_SetString(PyExc_OverflowError, "tags exceed the 32-bit offsets of an Arrow string array");
+            return nullptr;
+        }
+        buffer_object* data = new_buffer(ends[n], 1, "B");
+        if(data == nullptr){
+            Py_DECREF(offsets);
+            return nullptr;
+        }
+        parallel_for(n, threads, [&](std::size_t begin, std::size_t end){
+            tag_encode_column(serials + begin, end - begin, data->data, ends + begin);
+        });
+        return Py_BuildValue("(NN)", offsets, data);
+    }
+
+    PyObject* py_decode_arrow(PyObject*, PyObject* args, PyObject* kwargs){
+        static const char* keywords[] = {"data", "offsets", "threads", nullptr};
+        PyObject*          data_object = nullptr, *offsets_object = nullptr;
+        int                threads     = 0;
+        input_view         data, offsets;
+        if(!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|i", const_cast<char**>(keywords), &data_object, &offsets_object, &threads) ||
+           !data.acquire(data_object, "data") || !offsets.acquire(offsets_object, "offsets")){
+            return nullptr;
+        }
+        if(offsets.view.itemsize != 4 || offsets.type() != 'i' || offsets.size() < 1){
+            PyErr_SetString(PyExc_TypeError, "offsets must be a non-empty int32 array");
+            return nullptr;
+        }
+        const std::int32_t* ends = static_cast<const std::int32_t*>(offsets.view.buf);
+        std::size_t         n    = offsets.size() - 1;
+        for(std::size_t i = 0; i < n; i++){                                         // the kernels trust their offsets
+            if(ends[i] < 0 || ends[i] > ends[i + 1] || ends[i + 1] > data.view.len){
+                PyErr_Format(PyExc_ValueError, "offsets[%zd] is out of order or past the end of data", static_cast<Py_ssize_t>(i + 1));
+                return nullptr;
+            }
+        }
+        buffer_object* values = new_buffer(n, 8, "q");
+        buffer_object* valid  = new_buffer(n, 1, "?");
+        if(values == nullptr || valid == nullptr){
+            Py_XDECREF(values);
+            Py_XDECREF(valid);
+            return nullptr;
+        }
+        const char* chars = static_cast<const char*>(data.view.buf);
+        parallel_for(n, threads, [&](std::size_t begin, std::size_t end){
+            std::size_t               count = end - begin;
+            std::vector<std::uint8_t> bits((count + 7) / 8);
+            tag_decode_batch(chars, ends + begin, count, reinterpret_cast<std::int64_t*>(values->data) + begin, bits.data());
+            for(std::size_t i = 0; i < count; i++){
+                valid->data[begin + i] = bits[i / 8] >> (i % 8) & 1;
+            }
+        });
+        return Py_BuildValue("(NN)", values, valid);
+    }
+
+    PyMethodDef methods[] = {
+        {"encode", py_encode, METH_O, "encode(serial) -> str: the tag of a non-negative serial number"},
+        {"decode", py_decode, METH_O, "decode(tag) -> int: the serial number of a tag; ValueError if it is invalid"},
+        {"encode_batch", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(py_encode_batch)), METH_VARARGS | METH_KEYWORDS,
+         "encode_batch(serials, threads=0) -> Buffer of 16s: int64 or uint64 serials to NUL-padded 16-byte tags"},
+        {"decode_batch", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(py_decode_batch)), METH_VARARGS | METH_KEYWORDS,
+         "decode_batch(tags, threads=0, unsigned=False) -> (values, valid): fixed-width byte strings to serials and a mask"},
+        {"encode_arrow", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(py_encode_arrow)), METH_VARARGS | METH_KEYWORDS,
+         "encode_arrow(serials, threads=0) -> (offsets, data): int64 serials to an Arrow string array's buffers"},
+        {"decode_arrow", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(py_decode_arrow)), METH_VARARGS | METH_KEYWORDS,
+         "decode_arrow(data, offsets, threads=0) -> (values, valid): an Arrow string array's buffers to serials and a mask"},
+        {nullptr, nullptr, 0, nullptr}
+    };
+
+    PyModuleDef module = {PyModuleDef_HEAD_INIT, "tag_encode", "Reversible integer-to-tag encoding (C++ core).", -1, methods};
+}
+
+PyMODINIT_FUNC PyInit_tag_encode(){
+    if(PyType_Ready(&buffer_type) < 0){
+        return nullptr;
+    }
+    PyObject* result = PyModule_Create(&module);
+    if(result != nullptr){
+        Py_INCREF(&buffer_type);
+        if(PyModule_AddObject(result, "Buffer", reinterpret_cast<PyObject*>(&buffer_type)) < 0 ||
+           PyModule_AddIntConstant(result, "TAG_MAX_LENGTH", TAG_MAX_LENGTH) < 0){
+            Py_DECREF(&buffer_type);
+            Py_DECREF(result);
+            return nullptr;
+        }
+    }
+    return result;
+}
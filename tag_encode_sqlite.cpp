@@ -0,0 +1,107 @@
+/**
+ * @file tag_encode_sqlite.cpp
+ *
+ * SQLite loadable extension providing the SQL functions `tag_encode(serial)`
+ * and `tag_decode(tag)`, so rows can be fetched by tag without decoding in
+ * the application:
+ *
+ *     SELECT * FROM orders WHERE id = tag_decode(?1);
+ *     CREATE INDEX orders_by_tag ON orders(tag_encode(id));
+ *
+ * Both functions are registered as deterministic and innocuous, so SQLite
+ * evaluates a call with a constant argument once per statement (the lookup
+ * above uses the primary key) and accepts them in expression indexes,
+ * generated columns and CHECK constraints.
+ *
+ *  - `tag_encode(integer)` returns the tag as text; NULL gives NULL, and a
+ *    negative or non-integer argument is an error.
+ *  - `tag_decode(text)` returns the serial number; NULL and invalid tags
+ *    (anything `tag_try_decode()` refuses) give NULL, so a query never fails
+ *    on a bad tag.
+ *
+ * Build and load:
+ *     g++ -std=c++17 -O2 -fPIC -shared -o tag_encode.so tag_encode_sqlite.cpp
+ *     sqlite3 shop.db ".load ./tag_encode" "SELECT tag_encode(2147483646);"
+ *
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include<sqlite3ext.h>
+SQLITE_EXTENSION_INIT1
+
+#include "tag_encode.h"
+
+namespace{
+    /**
+     * @brief  `tag_encode(integer)`: the tag of a non-negative serial number
+     */
+    void sql_tag_encode(sqlite3_context* context, int, sqlite3_value** argv){
+        if(sqlite3_value_type(argv[0]) == SQLITE_NULL){
+            return;                                                                 // NULL result
+        }
+        if(sqlite3_value_numeric_type(argv[0]) != SQLITE_INTEGER){
+            sqlite3_result_error(context, "tag_encode: serial number must be an integer", -1);
+            return;
+        }
+        sqlite3_int64 serial = sqlite3_value_int64(argv[0]);
+        if(serial < 0){
+            sqlite3_result_error(context, "tag_encode: serial number must be non-negative", -1);
+            return;
+        }
+        char        tag[TAG_MAX_LENGTH];
+        std::size_t length = tag_encode(serial, tag, TAG_MAX_LENGTH);                // right-aligned; cannot throw here
+        sqlite3_result_text(context, tag + TAG_MAX_LENGTH - length, length, SQLITE_TRANSIENT);
+    }
+
+    /**
+     * @brief  `tag_decode(text)`: the serial number of a tag, or NULL if it is not a valid tag
+     */
+    void sql_tag_decode(sqlite3_context* context, int, sqlite3_value** argv){
+        if(sqlite3_value_type(argv[0]) == SQLITE_NULL){
+            return;
+        }
+        const char* tag    = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+        long int    serial = 0;
+        if(tag != nullptr &&
+           tag_try_decode(std::string_view(tag, sqlite3_value_bytes(argv[0])), serial) == tag_decode_status::ok){
+            sqlite3_result_int64(context, serial);
+        }
+    }
+}
+
+/**
+ * @brief  extension entry point, found by `.load ./tag_encode` / `load_extension('./tag_encode')`
+ */
+extern "C"
+#if defined(_WIN32)
+__declspec(dllexport)
+#endif
+int sqlite3_tagencode_init(sqlite3* db, char**, const sqlite3_api_routines* api){
+    SQLITE_EXTENSION_INIT2(api);
+    const int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
+    int       rc    = sqlite3_create_function(db, "tag_encode", 1, flags, nullptr, sql_tag_encode, nullptr, nullptr);
+    if(rc == SQLITE_OK){
+        rc = sqlite3_create_function(db, "tag_decode", 1, flags, nullptr, sql_tag_decode, nullptr, nullptr);
+    }
+    return rc;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file tag_encode_wasm.cpp
+ *
+ * WebAssembly build of the encoder and decoder, loaded by tag_encode_wasm.mjs
+ * in browsers and Node.  The exports are plain C functions over the module's
+ * linear memory; the wrapper copies strings and typed arrays in and out.
+ *
+ * `long int` is only 32 bits on wasm32, so every export goes through the
+ * 64-bit paths of "tag_encode.h" (`tag_encode_u64()`, `tag_try_decode_u64()`)
+ * and limits serial numbers to the non-negative `int64_t` range itself.  The
+ * tags are the same as those of a 64-bit native build.  Only non-throwing
+ * calls are made, so the module is built without exception support.
+ *
+ * Build (Emscripten 3.1 or later):
+ *     emcc -std=c++17 -O3 -DNDEBUG --no-entry -sSTANDALONE_WASM -sWASM_BIGINT -sALLOW_MEMORY_GROWTH \
+ *          -o tag_encode.wasm tag_encode_wasm.cpp
+ *
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include<cstdlib>
+
+#include "tag_encode.h"
+
+#if defined(__EMSCRIPTEN__)
+#include<emscripten.h>
+#define TAG_WASM_EXPORT extern "C" EMSCRIPTEN_KEEPALIVE
+#else
+#define TAG_WASM_EXPORT extern "C" __attribute__((visibility("default"), used))
+#endif
+
+namespace{
+    constexpr std::uint64_t SERIAL_MAX = std::numeric_limits<std::int64_t>::max();
+}
+
+/**
+ * @brief  allocate `size` bytes of linear memory for the wrapper's buffers
+ */
+TAG_WASM_EXPORT void* tag_wasm_alloc(std::size_t size){
+    return std::malloc(size);
+}
+
+/**
+ * @brief  release memory from `tag_wasm_alloc()`
+ */
+TAG_WASM_EXPORT void tag_wasm_free(void* memory){
+    std::free(memory);
+}
+
+/**
+ * @brief  encode one serial number into `out`, left-aligned
+ *
+ * @param  serial   serial number
+ * @param  out      buffer of at least `TAG_MAX_LENGTH` bytes
+ * @return          the tag length, or 0 if `serial` is negative
+ */
+TAG_WASM_EXPORT int tag_wasm_encode(std::int64_t serial, char* out){
+    if(serial < 0){
+        return 0;
+    }
+    std::uint64_t value = static_cast<std::uint64_t>(serial);
+    std::size_t   length = tag_encoded_length_u64(value);
+    tag_encode_detail::encode_unsigned(value, out + length);                        // written backwards from the end
+    return static_cast<int>(length);
+}
+
+/**
+ * @brief  decode one tag of `size` bytes
+ *
+ * @param  tag      tag characters
+ * @param  size     number of characters
+ * @param  serial   receives the serial number if the tag is valid
+ * @return          a `tag_decode_status` value (0 if the tag is valid)
+ */
+TAG_WASM_EXPORT int tag_wasm_decode(const char* tag, std::size_t size, std::int64_t* serial){
+    std::uint64_t     value  = 0;
+    tag_decode_status status = tag_try_decode_u64(std::string_view(tag, size), value);
+    if(status == tag_decode_status::ok && value > SERIAL_MAX){
+        status = tag_decode_status::overflow;                                       // past the last tag of a native build
+    }
+    if(status == tag_decode_status::ok){
+        *serial = static_cast<std::int64_t>(value);
+    }
+    return static_cast<int>(status);
+}
+
+/**
+ * @brief  first pass of the column encoder, as `tag_column_offsets()`
+ *
+ * @param  serials  serial numbers
+ * @param  n        number of serial numbers
+ * @param  offsets  receives `n + 1` offsets, starting at 0
+ * @return          the data size `tag_wasm_encode_column()` needs, -1 if a serial is negative,
+ *                  or -2 if the tags exceed the 32-bit offsets
+ */
+TAG_WASM_EXPORT std::int32_t tag_wasm_column_offsets(const std::int64_t* serials, std::size_t n, std::int32_t* offsets){
+    std::int64_t end = 0;
+    offsets[0] = 0;
+    for(std::size_t i = 0; i < n; i++){
+        if(serials[i] < 0){
+            return -1;
+        }
+        end += tag_encoded_length_u64(static_cast<std::uint64_t>(serials[i]));
+        if(end > std::numeric_limits<std::int32_t>::max()){
+            return -2;
+        }
+        offsets[i + 1] = static_cast<std::int32_t>(end);
+    }
+    return static_cast<std::int32_t>(end);
+}
+
+/**
+ * @brief  second pass of the column encoder, as `tag_encode_column()`
+ *
+ * @param  serials  the serial numbers given to `tag_wasm_column_offsets()`
+ * @param  n        number of serial numbers
+ * @param  data     value buffer of `offsets[n]` bytes
+ * @param  offsets  offsets from `tag_wasm_column_offsets()`
+ */
+TAG_WASM_EXPORT void tag_wasm_encode_column(const std::int64_t* serials, std::size_t n, char* data, const std::int32_t* offsets){
+    for(std::size_t i = 0; i < n; i++){
+        tag_encode_detail::encode_unsigned(static_cast<std::uint64_t>(serials[i]), data + offsets[i + 1]);
+    }
+}
+
+/**
+ * @brief  decode offset-indexed tags, as the offset form of `tag_decode_batch()`
+ *
+ * @param  data     concatenated tag characters
+ * @param  offsets  `n + 1` offsets into `data`
+ * @param  n        number of tags
+ * @param  out      receives `n` serial numbers, 0 for each invalid tag
+ * @param  valid    receives a validity bitmap of `(n + 7) / 8` bytes (least-significant bit first)
+ * @return          number of valid tags
+ */
+TAG_WASM_EXPORT std::size_t tag_wasm_decode_column(const char* data, const std::int32_t* offsets, std::size_t n,
+                                                   std::int64_t* out, std::uint8_t* valid){
+    std::size_t count = 0;
+    std::fill(valid, valid + (n + 7) / 8, std::uint8_t(0));
+    for(std::size_t i = 0; i < n; i++){
+        std::int64_t serial = 0;
+        bool         ok     = tag_wasm_decode(data + offsets[i], offsets[i + 1] - offsets[i], &serial) == 0;
+        out[i]         = serial;
+        valid[i / 8]  |= static_cast<std::uint8_t>(ok) << (i % 8);
+        count         += ok;
+    }
+    return count;
+}
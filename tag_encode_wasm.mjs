@@ -0,0 +1,242 @@
+/**
+ * @file tag_encode_wasm.mjs
+ *
+ * `tag_encode()` and `tag_decode()` for browsers and Node, backed by the C++
+ * encoder compiled to WebAssembly (tag_encode_wasm.cpp -> tag_encode.wasm).
+ * Unlike tag_encode.js, which computes with JavaScript numbers and loses
+ * precision above 2^53, every serial number up to 2^63 - 1 works, and the
+ * batch functions encode or decode a whole typed array in one call.
+ *
+ *     import { init, tag_encode, tag_decode } from "./tag_encode_wasm.mjs";
+ *     await init();                                   // once, before the first call
+ *     tag_encode(2147483646);                         // "ba9n82dq"
+ *     tag_decode("ba9n82dq");                         // 2147483646
+ *
+ * `tag_encode()` and `tag_decode()` keep the signatures and the thrown
+ * messages of tag_encode.js.  A serial number may also be given as a
+ * `BigInt`; a decoded serial number is returned as a `Number` when it is
+ * exactly representable (up to `Number.MAX_SAFE_INTEGER`) and as a `BigInt`
+ * otherwise.
+ *
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+const SCRATCH_CHARS   = 24;                                                         // longest string tried; 2^63 - 1 is 15 characters
+const STATUS_BLANK    = 1;                                                          // tag_decode_status::blank
+const COLUMN_NEGATIVE = -1;                                                         // tag_wasm_column_offsets(): a serial is negative
+const COLUMN_TOO_BIG  = -2;                                                         // tag_wasm_column_offsets(): past 32-bit offsets
+
+let wasm    = null;                                                                 // exports of the instantiated module
+let scratch = 0;                                                                    // SCRATCH_CHARS characters, then one int64
+
+/**
+ * @brief  load the WebAssembly module; must complete before any other call
+ *
+ * @param  source  URL of tag_encode.wasm, its bytes, or a compiled `WebAssembly.Module`
+ *                 (by default the file next to this module, read from disk under Node)
+ * @return         a promise resolved once the functions are usable
+ */
+export async function init(source = new URL("tag_encode.wasm", import.meta.url)){
+    if(wasm !== null){
+        return;
+    }
+    let module = source;
+    if(!(source instanceof WebAssembly.Module)){
+        if(typeof source === "string" || source instanceof URL){
+            const url = new URL(source, import.meta.url);
+            if(url.protocol === "file:"){                                           // Node's fetch() does not read files
+                const { readFile } = await import("node:fs/promises");
+                source = await readFile(url);
+            }else{
+                source = await (await fetch(url)).arrayBuffer();
+            }
+        }
+        module = await WebAssembly.compile(source);
+    }
+    const imports = {};                                                             // only reached by abort(): make it throw
+    for(const { module: name, name: field, kind } of WebAssembly.Module.imports(module)){
+        if(kind === "function"){
+            (imports[name] ??= {})[field] = () => { throw new Error("tag_encode.wasm: aborted"); };
+        }
+    }
+    const instance = await WebAssembly.instantiate(module, imports);
+    wasm = instance.exports;
+    if(wasm._initialize){
+        wasm._initialize();                                                         // static constructors of a reactor module
+    }
+    scratch = wasm.tag_wasm_alloc(SCRATCH_CHARS + 8);
+}
+
+/**
+ * @brief  the serial number as a BigInt, with the checks of tag_encode.js
+ */
+function serial_bigint(serial){
+    if(serial < 0){
+        throw "Serial number must be non-negative.";
+    }
+    if(typeof serial === "bigint"){
+        if(serial > 0x7fffffffffffffffn){
+            throw "Serial number must be less than 2^63.";
+        }
+        return serial;
+    }
+    if(!Number.isInteger(serial) || serial >= 2 ** 63){
+        throw "Serial number must be an integer less than 2^63.";
+    }
+    return BigInt(serial);
+}
+
+/**
+ * @brief  encode a non-negative integer into alphanumeric "tag" string
+ *
+ * @param  serial non-negative integer serial number (`Number` or `BigInt`)
+ * @return        alphanumeric "tag" string that is both web- and human-friendly
+ */
+export function tag_encode(serial){
+    const length = wasm.tag_wasm_encode(serial_bigint(serial), scratch);
+    const chars  = new Uint8Array(wasm.memory.buffer, scratch, length);
+    return String.fromCharCode.apply(null, chars);
+}
+
+/**
+ * @brief  decode an alphanumeric "tag" string into its corresponding integer
+ *
+ * Accepts upper- and lower-case tags and the digits '0' and '1' for 'o' and
+ * 'l', as `tag_try_decode()` does.
+ *
+ * @throw  "Tag cannot be blank."   thrown if the tag is blank
+ * @throw  "Invalid input tag."     thrown if the string is not a valid tag
+ *
+ * @param  tag_str  "tag" string as produced by the `tag_encode` function
+ * @return          the serial number: a `Number` if it is at most
+ *                  `Number.MAX_SAFE_INTEGER`, a `BigInt` otherwise
+ */
+export function tag_decode(tag_str){
+    const size = tag_str.length;
+    let   ascii = size <= SCRATCH_CHARS;
+    if(ascii){
+        const chars = new Uint8Array(wasm.memory.buffer, scratch, size);
+        for(let i = 0; i < size; i++){
+            const code = tag_str.charCodeAt(i);
+            ascii      = ascii && code < 0x80;                                      // a wider code unit is never a tag character
+            chars[i]   = code;
+        }
+    }
+    const status = ascii ? wasm.tag_wasm_decode(scratch, size, scratch + SCRATCH_CHARS) : -1;
+    if(status === STATUS_BLANK){
+        throw "Tag cannot be blank.";
+    }
+    if(status !== 0){
+        throw "Invalid input tag: \"" + tag_str + "\"";
+    }
+    const serial = new BigInt64Array(wasm.memory.buffer, scratch + SCRATCH_CHARS, 1)[0];
+    return serial <= BigInt(Number.MAX_SAFE_INTEGER) ? Number(serial) : serial;
+}
+
+/**
+ * @brief  copy typed arrays into linear memory, run `body` on their addresses, then free them
+ */
+function with_buffers(arrays, sizes, body){
+    const addresses = [];
+    try{
+        for(let i = 0; i < sizes.length; i++){
+            const address = wasm.tag_wasm_alloc(Math.max(sizes[i], 1));
+            if(address === 0){
+                throw new RangeError("tag_encode.wasm: out of memory");
+            }
+            addresses.push(address);
+            if(arrays[i]){
+                new Uint8Array(wasm.memory.buffer, address, sizes[i]).set(new Uint8Array(arrays[i].buffer, arrays[i].byteOffset, sizes[i]));
+            }
+        }
+        return body(...addresses);
+    }finally{
+        addresses.forEach(address => wasm.tag_wasm_free(address));
+    }
+}
+
+/**
+ * @brief  encode a column of serial numbers in one call
+ *
+ * @throw  "Serial number must be non-negative."    thrown if a serial number is negative
+ * @throw  RangeError                               thrown if the tags exceed 2^31 - 1 characters in all
+ *
+ * @param  serials  `BigInt64Array` of non-negative serial numbers
+ * @return          `{ data, offsets }`: the tag characters concatenated in a `Uint8Array`,
+ *                  and an `Int32Array` of `serials.length + 1` offsets (tag `i` is
+ *                  `data.subarray(offsets[i], offsets[i + 1])`), as in an Arrow string column
+ */
+export function tag_encode_batch(serials){
+    const n = serials.length;
+    return with_buffers([serials, null], [8 * n, 4 * (n + 1)], (serials_at, offsets_at) => {
+        const size = wasm.tag_wasm_column_offsets(serials_at, n, offsets_at);
+        if(size === COLUMN_NEGATIVE){
+            throw "Serial number must be non-negative.";
+        }
+        if(size === COLUMN_TOO_BIG){
+            throw new RangeError("tag_encode_batch: tags exceed the 32-bit offsets of a string column");
+        }
+        return with_buffers([null], [size], data_at => {
+            wasm.tag_wasm_encode_column(serials_at, n, data_at, offsets_at);
+            return {
+                data:    new Uint8Array(wasm.memory.buffer, data_at, size).slice(),
+                offsets: new Int32Array(wasm.memory.buffer, offsets_at, n + 1).slice(),
+            };
+        });
+    });
+}
+
+/**
+ * @brief  decode a column of tags in one call
+ *
+ * Invalid tags do not stop the batch: they give a serial number of 0 and a
+ * clear bit in `valid`.
+ *
+ * @throw  RangeError   thrown if the offsets are out of order or outside `data`
+ *
+ * @param  data     `Uint8Array` of concatenated tag characters
+ * @param  offsets  `Int32Array` of `n + 1` ascending offsets into `data`
+ * @return          `{ serials, valid, count }`: a `BigInt64Array` of `n` serial numbers,
+ *                  a `Uint8Array` validity bitmap (bit `i % 8` of byte `i / 8`), and
+ *                  the number of valid tags
+ */
+export function tag_decode_batch(data, offsets){
+    const n = offsets.length - 1;
+    if(n < 0 || offsets[0] < 0){
+        throw new RangeError("tag_decode_batch: offsets must hold at least one entry, the first non-negative");
+    }
+    for(let i = 0; i < n; i++){                                                     // the module trusts its offsets
+        if(offsets[i] > offsets[i + 1] || offsets[i + 1] > data.length){
+            throw new RangeError("tag_decode_batch: offsets[" + (i + 1) + "] is out of order or past the end of data");
+        }
+    }
+    return with_buffers([data, offsets, null, null], [data.length, 4 * (n + 1), 8 * n, (n + 7) >> 3],
+                        (data_at, offsets_at, serials_at, valid_at) => {
+        const count = wasm.tag_wasm_decode_column(data_at, offsets_at, n, serials_at, valid_at);
+        return {
+            serials: new BigInt64Array(wasm.memory.buffer, serials_at, n).slice(),
+            valid:   new Uint8Array(wasm.memory.buffer, valid_at, (n + 7) >> 3).slice(),
+            count:   count,
+        };
+    });
+}
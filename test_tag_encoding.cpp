@@ -33,14 +33,68 @@
 #include<string>
 #include<limits>
 #include<ctime>
+#include<vector>
+#include<cstdint>
+#include<cstring>
+#include<algorithm>
+#include<random>
+#include<cctype>
+#include<unordered_map>
 
 #include "tag_encode.h"
 
+static_assert("ba9n82dq"_tag == 2147483646L, "tag literal decodes at compile time");
+static_assert("BA9N82DQ"_tag == 2147483646L && "3oa"_tag == "30a"_tag, "tag literal folds case and '0'/'1'");
+static_assert(tag_constant<2147483646L> == "ba9n82dq" && tag_constant<0> == "2", "tag_constant encodes at compile time");
+static_assert(tag_constant<std::numeric_limits<long int>::max()> == "6eh5g28yq5mi7br", "tag_constant covers 'long int'");
+static_assert(!tag_try_decode("ba9n82d!").has_value(), "tag_try_decode rejects at compile time");
+static_assert(*++tag_counter("ba9n82dq"_tag) == "ba9n82dr" && *++tag_counter("zz"_tag) == "3a2", "tag_counter carries at compile time");
+static_assert(tag_scrambler(1, 2).unscramble(tag_scrambler(1, 2).scramble(2147483646L)) == 2147483646L, "tag_scrambler inverts at compile time");
+static_assert(TAG_MAX_LENGTH_CHECKED == 16 && []{ long int s = -1; return tag_try_decode_checked("2", s) == tag_decode_status::ok && s == 0; }(), "checked tags decode at compile time");
+static_assert(TAG_MAX_LENGTH_U64 == 16 && tag_encoded_length_u64(~std::uint64_t(0)) == 16, "unsigned 64-bit tags reach 16 characters");
+#if defined(__SIZEOF_INT128__)
+static_assert(TAG_MAX_LENGTH_U128 == 31 && tag_encoded_length_u128(~tag_uint128_t(0)) == 31, "unsigned 128-bit tags reach 31 characters");
+
+/**
+ * Reference for the unsigned 128-bit encoder: one (slow) 128-bit division per character.
+ */
+static std::string reference_tag_u128(tag_uint128_t serial){
+	std::string tag;
+	int         position = 0;
+	do{
+		int digit_base = BASE_SELECT[position++ % 3];
+		tag.insert(tag.begin(), tag_encode_detail::digit_char(static_cast<int>(serial % digit_base), digit_base));
+		serial /= digit_base;
+	}while(serial > 0);
+	return tag;
+}
+#endif
+
+/**
+ * `tag_codec` alphabets for printed labels (upper case, no I or O) and phone keypads.
+ */
+struct label_alphabet{
+	static constexpr std::string_view symbols = "23456789ABCDEFGHJKLMNPQRSTUVWXYZ";
+	static constexpr std::string_view aliases = "";
+};
+
+struct keypad_alphabet{
+	static constexpr std::string_view symbols = "0123456789";
+	static constexpr std::string_view aliases = "o0";
+};
+
+static_assert(tag_is_plausible("BA9N82DQ") && tag_is_plausible("3oa") && !tag_is_plausible("ba9n82d!") && !tag_is_plausible("2a2a") &&
+              !tag_is_plausible("6eh5g28yq5mi7br2") && !tag_is_plausible(""), "tag_is_plausible checks classes at compile time");
+static_assert(tag_codec<keypad_alphabet, tag_radix<0, 10>>::encoded_length(999) == 3, "tag_codec sizes tags at compile time");
+static_assert(tag_value(2147483646L) == *tag_value::try_parse("BA9N82DQ") && tag_value(2147483646L).serial() == 2147483646L && tag_value(9L) < tag_value(34L),
+              "tag_value encodes, parses and orders at compile time");
+
 int main(int argc, const char* argv[]){
 	std::string s;
 	long int    ds;
 	bool        ok         = true;
 	time_t      start_time = time(0);
+	tag_counter counter;     // steps alongside the encoder
 
 	std::cout << "First 200 values, or until first mis-matched value, if any: \n";
 	for(long int i = 0; ok && (time(0) < start_time + 90) && i < std::numeric_limits<long int>::max() / 1000; i++){
@@ -50,12 +104,13 @@ int main(int argc, const char* argv[]){
 			std::cout << i << "\t" << s << "\t" << ds << std::endl;
 			std::cout << (i == 199 ? "Testing wide range of values; this could take up to 90 seconds... Please be patient...\n" : "");
 		}
-		if(i != ds){         // always test for a mismatch
+		if(i != ds || tag_encoded_length(i) != s.size() || counter.tag() != s){   // always test for a mismatch
 			for(int j = i - 5; j <= i; j++){
 				std::cout << j << "\t" << tag_encode(j) << "\t" << tag_decode(tag_encode(j)) << std::endl;
 			}
 			ok = false;
-		}		
+		}
+		++counter;
 	}
 	if(ok){                  // if all went well, say so
 		std::cout << "Encode/Decode test passed OK!\n";
@@ -80,6 +135,760 @@ int main(int argc, const char* argv[]){
 	std::cout << "Testing conversion of case and mis-used '0' and '1' digits: " << std::endl;
 	std::cout << "Converting 30A: " << tag_decode("30a") << "\t" << tag_decode("3oa") << std::endl;
 	std::cout << "Converting 31A: " << tag_decode("31a") << "\t" << tag_decode("3la") << std::endl;
+	std::cout << "Compile-time:   " << "ba9n82dq"_tag << "\t" << tag_constant<2147483646L> << std::endl;
+
+	std::cout << "\n";
+	std::cout << "Testing tag lengths and buffer encoding at every length threshold: " << std::endl;
+	bool lengths_ok = true;
+	for(long int bound = 1, position = 0; position < TAG_MAX_LENGTH; position++){
+		for(long int j = bound - 1; j <= bound; j++){
+			char        buffer[TAG_MAX_LENGTH + 2] = "################";
+			std::size_t length = tag_encode(j, buffer, sizeof(buffer) - 1);
+			std::string tag    = tag_encode(j);
+			if(length != tag.size() || length != tag_encoded_length(j) ||
+			   tag != std::string(buffer + sizeof(buffer) - 1 - length, length) ||
+			   buffer[sizeof(buffer) - 2 - length] != '#'){
+				std::cout << "Length mismatch on " << j << "\t" << tag << "\t" << length << std::endl;
+				lengths_ok = false;
+			}
+		}
+		if(bound > std::numeric_limits<long int>::max() / BASE_SELECT[position % 3]){
+			break;
+		}
+		bound *= BASE_SELECT[position % 3];
+	}
+	try{
+		char buffer[4];
+		tag_encode(std::numeric_limits<long int>::max(), buffer, sizeof(buffer));
+		lengths_ok = false;
+	}catch(std::length_error&){}
+	std::cout << (lengths_ok ? "Length test passed OK!" : "Length test FAILED!") << std::endl;
+	ok = ok && lengths_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing group-table encoder against per-character loop: " << std::endl;
+	bool kernels_ok = true;
+	for(long int j = 0, step = 1; j >= 0 && j < std::numeric_limits<long int>::max() - step; j += step, step += step / 64 + 1){
+		char by_digits[TAG_MAX_LENGTH], by_groups[TAG_MAX_LENGTH];
+		std::size_t length = tag_encoded_length(j);
+		tag_encode_detail::encode_digits(j, by_digits + TAG_MAX_LENGTH);
+		tag_encode_detail::encode_groups(j, by_groups + TAG_MAX_LENGTH);
+		if(std::string(by_digits + TAG_MAX_LENGTH - length, length) != std::string(by_groups + TAG_MAX_LENGTH - length, length)){
+			std::cout << "Kernel mismatch on " << j << std::endl;
+			kernels_ok = false;
+		}
+	}
+	std::cout << (kernels_ok ? "Kernel test passed OK!" : "Kernel test FAILED!") << std::endl;
+	ok = ok && kernels_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing rejection of tags tag_encode() never produces: " << std::endl;
+	const char* invalid_tags[] = {"", "22", "2z", "2a3", "b2b", "9b", "zzz", "2oo", "6eh5g28yq5mi7bs", "9eh5g28yq5mi7bq",
+	                              "2bab2b", "ba9n82d!", "ba9n 82dq", "22222222222222222", "ba9n82dq\n"};
+	bool rejects_ok = true;
+	for(const char* bad_tag : invalid_tags){
+		try{
+			ds = tag_decode(bad_tag);
+			std::cout << "Accepted invalid tag \"" << bad_tag << "\" as " << ds << std::endl;
+			rejects_ok = false;
+		}catch(std::invalid_argument&){}
+	}
+	rejects_ok = rejects_ok && tag_decode("6eh5g28yq5mi7br") == std::numeric_limits<long int>::max();
+	struct { const char* tag; tag_decode_status status; } statuses[] = {
+		{"", tag_decode_status::blank},           {"2z", tag_decode_status::bad_char},
+		{"BA9N82DQ", tag_decode_status::ok},      {"2a3", tag_decode_status::non_canonical},
+		{"6eh5g28yq5mi7bs", tag_decode_status::overflow}, {"ba9n82d!", tag_decode_status::bad_char}
+	};
+	for(auto& expected : statuses){
+		long int serial = -1;
+		if(tag_try_decode(expected.tag, serial) != expected.status || tag_try_decode(expected.tag).has_value() != (serial >= 0)){
+			std::cout << "Wrong status for \"" << expected.tag << "\"" << std::endl;
+			rejects_ok = false;
+		}
+	}
+	rejects_ok = rejects_ok && tag_try_decode("ba9n82dq") == 2147483646L;
+	std::cout << (rejects_ok ? "Rejection test passed OK!" : "Rejection test FAILED!") << std::endl;
+	ok = ok && rejects_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing batch encoding against tag_encode(): " << std::endl;
+	bool batch_ok = true;
+	std::vector<std::int64_t> serials = {-1, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()};
+	for(long int bound = 1, position = 0; bound <= std::numeric_limits<long int>::max() / BASE_SELECT[position % 3]; position++){
+		bound *= BASE_SELECT[position % 3];
+		serials.insert(serials.end(), {bound - 1, bound, bound + 1});
+	}
+	for(std::int64_t j = 0; serials.size() < 10007; j = j * 3 + 7){
+		serials.push_back(j < 0 ? -j : j);
+		serials.push_back(serials.size());
+	}
+	std::vector<char>         slots(serials.size() * TAG_BATCH_STRIDE, '#');
+	std::vector<std::uint8_t> lens(serials.size());
+	tag_encode_batch(serials.data(), serials.size(), slots.data(), lens.data());
+	for(std::size_t j = 0; j < serials.size(); j++){
+		std::string expected = serials[j] < 0 ? "" : tag_encode(serials[j]);
+		if(lens[j] != expected.size() || std::string(&slots[j * TAG_BATCH_STRIDE]) != expected){
+			std::cout << "Batch mismatch on " << serials[j] << "\t" << &slots[j * TAG_BATCH_STRIDE] << std::endl;
+			batch_ok = false;
+		}
+	}
+	std::vector<char>         reference(slots.size());
+	std::vector<std::uint8_t> reference_lens(lens.size());
+	tag_encode_detail::encode_batch_scalar(serials.data(), serials.size(), reference.data(), reference_lens.data());
+	batch_ok = batch_ok && reference == slots && reference_lens == lens;
+	std::cout << (batch_ok ? "Batch test passed OK!" : "Batch test FAILED!") << std::endl;
+	ok = ok && batch_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing batch decoding against tag_try_decode(): " << std::endl;
+	bool decode_ok = true;
+	const char  noise[] = "0123456789aAlLoOzZ!\x80\xff";
+	std::size_t tags    = slots.size() / TAG_BATCH_STRIDE;
+	for(std::size_t j = 0; j < tags; j++){                 // mutate a copy of every tag
+		std::string tag = &slots[j * TAG_BATCH_STRIDE];
+		if(!tag.empty()){
+			tag[j % tag.size()] = noise[j % (sizeof(noise) - 1)];
+		}
+		tag = (j % 7 == 0) ? "2" + tag : (j % 11 == 0) ? tag + "z" : tag;
+		slots.resize(slots.size() + TAG_BATCH_STRIDE);
+		std::strncpy(&slots[slots.size() - TAG_BATCH_STRIDE], tag.c_str(), TAG_BATCH_STRIDE);
+	}
+	tags = slots.size() / TAG_BATCH_STRIDE;
+	std::vector<std::int64_t> decoded(tags), reference_decoded(tags), offset_decoded(tags);
+	std::vector<std::uint8_t> valid((tags + 7) / 8), reference_valid(valid.size()), offset_valid(valid.size());
+	std::string               column;
+	std::vector<std::int32_t> offsets = {0};
+	for(std::size_t j = 0; j < tags; j++){
+		const char* slot = &slots[j * TAG_BATCH_STRIDE];
+		column.append(slot, std::find(slot, slot + TAG_BATCH_STRIDE, '\0'));
+		offsets.push_back(column.size());
+	}
+	tag_decode_batch(slots.data(), tags, decoded.data(), valid.data());
+	tag_decode_batch(column.data(), offsets.data(), tags, offset_decoded.data(), offset_valid.data());
+	tag_encode_detail::decode_batch_scalar(slots.data(), tags, reference_decoded.data(), reference_valid.data());
+	for(std::size_t j = 0; j < tags; j++){
+		long int serial   = 0;
+		bool     expected = tag_try_decode(std::string_view(column).substr(offsets[j], offsets[j + 1] - offsets[j]), serial) == tag_decode_status::ok;
+		bool     got      = valid[j / 8] >> (j % 8) & 1;
+		if(got != expected || decoded[j] != (expected ? serial : 0)){
+			std::cout << "Batch decode mismatch on \"" << &slots[j * TAG_BATCH_STRIDE] << "\"" << std::endl;
+			decode_ok = false;
+		}
+	}
+	decode_ok = decode_ok && decoded == reference_decoded && valid == reference_valid &&
+	            decoded == offset_decoded && valid == offset_valid;
+	std::cout << (decode_ok ? "Batch decode test passed OK!" : "Batch decode test FAILED!") << std::endl;
+	ok = ok && decode_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing fixed-width padded tags: " << std::endl;
+	bool padded_ok = true;
+	for(long int j = 0, step = 1; j >= 0 && j < std::numeric_limits<long int>::max() - step; j += step, step += step / 64 + 1){
+		std::string tag = tag_encode(j);
+		for(std::size_t width = tag.size(); width <= static_cast<std::size_t>(TAG_MAX_LENGTH); width++){
+			std::string padded = tag_encode_padded(j, width);
+			long int    serial = -1;
+			bool        alternates = true;                       // padding must keep the class of every position
+			for(std::size_t i = 0; i < width; i++){
+				alternates = alternates && tag_try_decode_padded(padded.substr(i)).has_value();
+			}
+			if(padded.size() != width || padded.compare(width - tag.size(), tag.size(), tag) != 0 || !alternates ||
+			   tag_try_decode_padded(padded, serial) != tag_decode_status::ok || serial != j ||
+			   (width > tag.size() && tag_try_decode(padded).has_value())){
+				std::cout << "Padding mismatch on " << j << "\t" << padded << std::endl;
+				padded_ok = false;
+			}
+		}
+	}
+	try{
+		tag_encode_padded(2147483646L, 7);
+		padded_ok = false;
+	}catch(std::length_error&){}
+	try{
+		tag_encode_padded(0, TAG_MAX_LENGTH + 1);
+		padded_ok = false;
+	}catch(std::length_error&){}
+	padded_ok = padded_ok && tag_encode_padded(2147483646L, 10) == "22ba9n82dq" && tag_try_decode_padded("A22A22A2") == 0L &&
+	            tag_try_decode_padded("2a") == std::nullopt && tag_try_decode_padded("922222222222222") == std::nullopt;
+	std::cout << (padded_ok ? "Padded test passed OK!" : "Padded test FAILED!") << std::endl;
+	ok = ok && padded_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing that padded tags and tag_compare() sort like serial numbers: " << std::endl;
+	bool order_ok = true;
+	std::vector<long int> ordered_serials;
+	for(long int j = 0, step = 1; j >= 0 && j < std::numeric_limits<long int>::max() - step; j += step, step += step / 16 + 1){
+		ordered_serials.push_back(j);
+		ordered_serials.push_back(j + 1);
+	}
+	ordered_serials.push_back(std::numeric_limits<long int>::max());
+	for(std::size_t i = 1; i < ordered_serials.size(); i++){
+		long int    lo = ordered_serials[i - 1], hi = ordered_serials[i];
+		std::string lo_padded = tag_encode_padded(lo, TAG_MAX_LENGTH), hi_padded = tag_encode_padded(hi, TAG_MAX_LENGTH);
+		int         expected  = (lo > hi) - (lo < hi);
+		int         by_bytes  = std::memcmp(lo_padded.data(), hi_padded.data(), TAG_MAX_LENGTH);
+		int         by_tags   = tag_compare(tag_encode(lo), tag_encode(hi));
+		if(((by_bytes > 0) - (by_bytes < 0)) != expected || ((by_tags > 0) - (by_tags < 0)) != expected ||
+		   tag_compare(tag_encode(hi), tag_encode(lo)) != -by_tags || tag_compare(tag_encode(lo), tag_encode(lo)) != 0){
+			std::cout << "Order mismatch on " << lo << " and " << hi << std::endl;
+			order_ok = false;
+		}
+	}
+	std::cout << (order_ok ? "Order test passed OK!" : "Order test FAILED!") << std::endl;
+	ok = ok && order_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing tag_counter across every length threshold: " << std::endl;
+	bool counter_ok = true;
+	for(std::size_t position = 0; position + 1 < static_cast<std::size_t>(TAG_MAX_LENGTH); position++){
+		long int    first = std::max(0L, static_cast<long int>(tag_encode_detail::LENGTHS.limit[position]) - 40);
+		tag_counter stepper(first);
+		for(long int j = first; j < first + 80; j++, ++stepper){
+			if(stepper.serial() != j || *stepper != tag_encode(j) || tag_counter(first).advance(j - first).tag() != tag_encode(j)){
+				std::cout << "Counter mismatch on " << j << "\t" << *stepper << std::endl;
+				counter_ok = false;
+			}
+		}
+	}
+	tag_counter last(std::numeric_limits<long int>::max() - 1);
+	counter_ok = counter_ok && (last++).tag() == tag_encode(std::numeric_limits<long int>::max() - 1) &&
+	             last.tag() == tag_encode(std::numeric_limits<long int>::max()) && last == tag_counter(std::numeric_limits<long int>::max());
+	try{
+		++last;
+		counter_ok = false;
+	}catch(std::overflow_error&){}
+	try{
+		tag_counter(1).advance(std::numeric_limits<long int>::max());
+		counter_ok = false;
+	}catch(std::overflow_error&){}
+	try{
+		tag_counter negative(-1);
+		counter_ok = false;
+	}catch(std::out_of_range&){}
+	std::cout << (counter_ok ? "Counter test passed OK!" : "Counter test FAILED!") << std::endl;
+	ok = ok && counter_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing unsigned 64-bit and 128-bit serial numbers: " << std::endl;
+	bool wide_ok = true;
+	for(long int j = 0, step = 1; j >= 0 && j < std::numeric_limits<long int>::max() - step; j += step, step += step / 16 + 1){
+		std::uint64_t serial = 0;
+		std::string   tag    = tag_encode_u64(j);
+		if(tag != tag_encode(j) || tag_encoded_length_u64(j) != tag.size() ||
+		   tag_try_decode_u64(tag, serial) != tag_decode_status::ok || serial != static_cast<std::uint64_t>(j)){
+			std::cout << "Unsigned 64-bit mismatch on " << j << "\t" << tag << std::endl;
+			wide_ok = false;
+		}
+	}
+#if defined(__SIZEOF_INT128__)
+	std::vector<tag_uint128_t> wide_serials;
+	std::mt19937_64            wide_random(20130101);
+	for(int width = 0; width <= 128; width++){
+		tag_uint128_t power = width < 128 ? tag_uint128_t(1) << width : 0;
+		wide_serials.push_back(power - 1);
+		wide_serials.push_back(power);
+		wide_serials.push_back(power + 1);
+		for(int sample = 0; sample < 64 && width > 0; sample++){
+			tag_uint128_t bits = (static_cast<tag_uint128_t>(wide_random()) << 64) | wide_random();
+			wide_serials.push_back(width < 128 ? (bits & (power - 1)) | (tag_uint128_t(1) << (width - 1)) : bits);
+		}
+	}
+	for(int length = 1; length < TAG_MAX_LENGTH_U128; length++){
+		tag_uint128_t threshold = tag_encode_detail::WIDE_LENGTHS<tag_uint128_t>.limit[length - 1];
+		for(int offset = -3; offset <= 3; offset++){
+			wide_serials.push_back(threshold + offset);
+		}
+	}
+	for(tag_uint128_t serial : wide_serials){
+		tag_uint128_t decoded = serial + 1;
+		std::uint64_t narrow  = 0;
+		std::string   tag     = tag_encode_u128(serial);
+		bool          fits    = (serial >> 64) == 0;
+		if(tag != reference_tag_u128(serial) || tag_encoded_length_u128(serial) != tag.size() ||
+		   tag_try_decode_u128(tag, decoded) != tag_decode_status::ok || decoded != serial || tag_decode_u128(tag) != serial ||
+		   (fits && (tag_encode_u64(static_cast<std::uint64_t>(serial)) != tag || tag_decode_u64(tag) != serial)) ||
+		   (!fits && tag_try_decode_u64(tag, narrow) != tag_decode_status::overflow)){
+			std::cout << "Unsigned 128-bit mismatch on " << tag << std::endl;
+			wide_ok = false;
+		}
+	}
+	std::string   wide_max = tag_encode_u128(~tag_uint128_t(0));
+	tag_uint128_t wide_serial = 0;
+	wide_ok = wide_ok && tag_try_decode_u128("4" + wide_max.substr(1), wide_serial) == tag_decode_status::overflow &&
+	          tag_try_decode_u128(wide_max.substr(0, TAG_MAX_LENGTH_U128 - 1) + "k", wide_serial) == tag_decode_status::overflow &&
+	          tag_try_decode_u128("b" + wide_max, wide_serial) == tag_decode_status::overflow &&
+	          tag_try_decode_u128("2" + wide_max.substr(1), wide_serial) == tag_decode_status::non_canonical;
+#endif
+	std::uint64_t narrow_serial = 0;
+	wide_ok = wide_ok && tag_encode_u64(~std::uint64_t(0)) == "32iw8m37xg8yz4dj" && tag_decode_u64("32IW8M37XG8YZ4DJ") == ~std::uint64_t(0) &&
+	          tag_try_decode_u64("32iw8m37xg8yz4dk", narrow_serial) == tag_decode_status::overflow &&
+	          tag_try_decode_u64("b32iw8m37xg8yz4dj", narrow_serial) == tag_decode_status::overflow &&
+	          tag_try_decode_u64("", narrow_serial) == tag_decode_status::blank;
+	try{
+		char small[TAG_MAX_LENGTH_U64 - 1];
+		tag_encode_u64(~std::uint64_t(0), small, sizeof(small));
+		wide_ok = false;
+	}catch(std::length_error&){}
+	try{
+		tag_decode_u64("3");
+		tag_decode_u64("3!");
+		wide_ok = false;
+	}catch(std::invalid_argument&){}
+	std::cout << (wide_ok ? "Unsigned test passed OK!" : "Unsigned test FAILED!") << std::endl;
+	ok = ok && wide_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing columnar encoding into one buffer with offsets: " << std::endl;
+	bool                      column_ok = true;
+	std::vector<std::int64_t> column_serials;
+	std::mt19937_64           column_random(20130102);
+	for(int j = 0; j < 5000; j++){
+		column_serials.push_back(static_cast<std::int64_t>(column_random() >> (1 + column_random() % 63)));
+	}
+	tag_column encoded;
+	encoded.assign(column_serials.data(), column_serials.size() / 2);
+	encoded.append(column_serials.data() + column_serials.size() / 2, column_serials.size() - column_serials.size() / 2);
+	std::size_t column_bytes = 0;
+	for(std::size_t i = 0; i < column_serials.size(); i++){
+		column_bytes += tag_encoded_length(column_serials[i]);
+		if(encoded[i] != tag_encode(column_serials[i]) || encoded.offsets()[i + 1] != static_cast<std::int32_t>(column_bytes)){
+			std::cout << "Column mismatch on " << column_serials[i] << "\t" << encoded[i] << std::endl;
+			column_ok = false;
+		}
+	}
+	std::vector<std::int64_t> column_decoded(encoded.size());
+	std::vector<std::uint8_t> column_valid((encoded.size() + 7) / 8);
+	tag_decode_batch(encoded.data(), encoded.offsets(), encoded.size(), column_decoded.data(), column_valid.data());
+	column_ok = column_ok && encoded.size() == column_serials.size() && encoded.data_size() == column_bytes &&
+	            encoded.offsets()[0] == 0 && column_decoded == column_serials &&
+	            std::all_of(column_valid.begin(), column_valid.end() - 1, [](std::uint8_t bits){ return bits == 0xFF; });
+	const char* column_buffer = encoded.data();
+	encoded.assign(column_serials.data() + 1, column_serials.size() - 1);     // reuse: no reallocation when it fits
+	column_ok = column_ok && encoded.data() == column_buffer && encoded[0] == tag_encode(column_serials[1]);
+	std::int64_t column_negative[] = {5, -1};
+	try{
+		encoded.append(column_negative, 2);
+		column_ok = false;
+	}catch(std::out_of_range&){}
+	column_ok = column_ok && encoded.size() == column_serials.size() - 1 &&
+	            encoded.data_size() == static_cast<std::size_t>(encoded.offsets()[encoded.size()]);
+	encoded.clear();
+	column_ok = column_ok && encoded.empty() && encoded.data_size() == 0;
+	std::cout << (column_ok ? "Column test passed OK!" : "Column test FAILED!") << std::endl;
+	ok = ok && column_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing keyed scrambling: " << std::endl;
+	bool scrambler_ok = true;
+	for(int bits = 2; bits <= 20; bits++){                    // every domain up to 2^20 is permuted exactly
+		tag_scrambler     scrambler(0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL ^ bits, bits);
+		std::vector<bool> seen(1L << bits);
+		for(long int j = 0; j < (1L << bits); j++){
+			long int scrambled = scrambler.scramble(j);
+			if(scrambled < 0 || scrambled >= (1L << bits) || seen[scrambled] || scrambler.unscramble(scrambled) != j){
+				std::cout << "Scrambler is not a permutation of " << bits << " bits at " << j << std::endl;
+				scrambler_ok = false;
+				break;
+			}
+			seen[scrambled] = true;
+		}
+	}
+	tag_scrambler   scrambler(0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL), other_key(0x243F6A8885A308D3ULL, 0x13198A2E03707345ULL);
+	std::mt19937_64 scrambler_random(20130103);
+	int             scrambled_matches = 0, scrambled_ascending = 0;
+	for(long int j = 0; j < 100000; j++){
+		long int    serial = j < 1000 ? j : static_cast<long int>(scrambler_random() >> 1);
+		long int    decoded = -1;
+		std::string tag = scrambler.encode(serial);
+		if(scrambler.unscramble(scrambler.scramble(serial)) != serial || scrambler.decode(tag) != serial ||
+		   scrambler.try_decode(tag, decoded) != tag_decode_status::ok || decoded != serial){
+			std::cout << "Scrambler mismatch on " << serial << "\t" << tag << std::endl;
+			scrambler_ok = false;
+		}
+		scrambled_matches   += scrambler.scramble(serial) == other_key.scramble(serial);
+		scrambled_ascending += j > 0 && j < 1000 && scrambler.scramble(j) > scrambler.scramble(j - 1);
+	}
+	long int      short_serial = -1;
+	tag_scrambler short_tags(1, 2, 35);
+	for(long int j = 0; j < 1000; j++){
+		scrambler_ok = scrambler_ok && short_tags.encode(j).size() <= 8;
+	}
+	scrambler_ok = scrambler_ok && scrambled_matches < 5 && scrambled_ascending > 400 && scrambled_ascending < 600 &&
+	               scrambler.unscramble(scrambler.scramble(std::numeric_limits<long int>::max())) == std::numeric_limits<long int>::max() &&
+	               short_tags.try_decode(tag_encode(1L << 35), short_serial) == tag_decode_status::overflow &&
+	               short_tags.try_decode("ba9n82d!", short_serial) == tag_decode_status::bad_char && short_serial == -1;
+	try{
+		short_tags.scramble(1L << 40);
+		scrambler_ok = false;
+	}catch(std::out_of_range&){}
+	try{
+		scrambler.encode(-1);
+		scrambler_ok = false;
+	}catch(std::out_of_range&){}
+	try{
+		tag_scrambler(1, 2, 64);
+		scrambler_ok = false;
+	}catch(std::invalid_argument&){}
+	try{
+		short_tags.decode(tag_encode(1L << 40));
+		scrambler_ok = false;
+	}catch(std::invalid_argument&){}
+	std::cout << (scrambler_ok ? "Scrambler test passed OK!" : "Scrambler test FAILED!") << std::endl;
+	ok = ok && scrambler_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing the tag scanner on text with embedded tags: " << std::endl;
+	bool            scanner_ok = true;
+	std::mt19937_64 scanner_random(20130104);
+	std::string     text;
+	const char*     words[] = {"GET", "/api/v1/item/", " the ", "https://example.com/t/", "?ref=", "\r\n", "_", "\xC3\xA9", "x", "A2"};
+	while(text.size() < 200000){
+		switch(scanner_random() % 4){
+			case 0:
+				text += words[scanner_random() % (sizeof(words) / sizeof(words[0]))];
+				break;
+			case 1:
+				text += tag_encode(static_cast<long int>(scanner_random() >> (1 + scanner_random() % 63)));
+				break;
+			case 2:
+				text += static_cast<char>(scanner_random() % 256);
+				break;
+			default:
+				text += std::string(1 + scanner_random() % 90, "b3c4dZ9"[scanner_random() % 7]);
+				break;
+		}
+	}
+	std::vector<tag_match> expected_matches;                  // reference: split on non-alphanumerics, decode every run
+	for(std::size_t i = 0; i < text.size();){
+		std::size_t j = i;
+		while(j < text.size() && std::isalnum(static_cast<unsigned char>(text[j]))){
+			j++;
+		}
+		long int serial = 0;
+		if(j - i >= 4 && tag_try_decode(std::string_view(text).substr(i, j - i), serial) == tag_decode_status::ok){
+			expected_matches.push_back(tag_match{i, j - i, serial});
+		}
+		i = std::max(j, i + 1);
+	}
+	auto same_matches = [&](const std::vector<tag_match>& found){
+		if(found.size() != expected_matches.size()){
+			return false;
+		}
+		for(std::size_t i = 0; i < found.size(); i++){
+			if(found[i].offset != expected_matches[i].offset || found[i].length != expected_matches[i].length || found[i].serial != expected_matches[i].serial){
+				std::cout << "Scanner mismatch at offset " << found[i].offset << std::endl;
+				return false;
+			}
+		}
+		return true;
+	};
+	std::vector<tag_match> found_matches;
+	std::size_t            found_count = tag_scan(text.data(), text.size(), [&](const tag_match& match){ found_matches.push_back(match); });
+	scanner_ok = scanner_ok && found_count == found_matches.size() && expected_matches.size() > 300 && same_matches(found_matches);
+	for(std::size_t chunk_limit : {std::size_t(1), std::size_t(7), std::size_t(200), std::size_t(10000)}){
+		tag_scanner stream;
+		found_matches.clear();
+		for(std::size_t i = 0; i < text.size();){
+			std::size_t chunk = std::min<std::size_t>(text.size() - i, 1 + scanner_random() % chunk_limit);
+			stream.feed(text.data() + i, chunk, [&](const tag_match& match){ found_matches.push_back(match); });
+			i += chunk;
+		}
+		scanner_ok = scanner_ok && stream.position() == text.size();
+		stream.finish([&](const tag_match& match){ found_matches.push_back(match); });
+		scanner_ok = scanner_ok && same_matches(found_matches) && stream.position() == 0;
+	}
+	std::vector<std::uint64_t> scalar_masks(text.size() / 64), kernel_masks(text.size() / 64);
+	tag_encode_detail::classify_scalar(text.data(), scalar_masks.size(), scalar_masks.data());
+	tag_encode_detail::classify_tag_chars(text.data(), kernel_masks.size(), kernel_masks.data());
+	scanner_ok = scanner_ok && scalar_masks == kernel_masks;
+#if TAG_ENCODE_AVX2
+	if(tag_encode_detail::cpu() >= tag_encode_detail::cpu_level::avx2){
+		tag_encode_detail::classify_avx2(text.data(), kernel_masks.size(), kernel_masks.data());
+		scanner_ok = scanner_ok && scalar_masks == kernel_masks;
+	}
+#endif
+#if TAG_ENCODE_AVX512
+	if(tag_encode_detail::cpu() >= tag_encode_detail::cpu_level::avx512){
+		tag_encode_detail::classify_avx512(text.data(), kernel_masks.size(), kernel_masks.data());
+		scanner_ok = scanner_ok && scalar_masks == kernel_masks;
+	}
+#endif
+	found_matches.clear();
+	std::string scan_text = "id=ba9n82dq,BA9N82DQ;a2 " + tag_encode(123456789L);
+	tag_scan(scan_text.data(), scan_text.size(), [&](const tag_match& match){ found_matches.push_back(match); });
+	scanner_ok = scanner_ok && found_matches.size() == 3 && found_matches[0].offset == 3 && found_matches[1].serial == 2147483646L &&
+	             found_matches[2].offset == 24 && found_matches[2].serial == 123456789L;
+	std::cout << (scanner_ok ? "Scanner test passed OK!" : "Scanner test FAILED!") << std::endl;
+	ok = ok && scanner_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing tags with a check character against typos: " << std::endl;
+	bool            checked_ok = true;
+	std::mt19937_64 checked_random(20130105);
+	const char*     symbols    = "23456789abcdefghijklmnopqrstuvwxyz";
+	std::string     last_checked;
+	for(long int j = 0; j < 100000; j++){
+		long int    serial = j < 50000 ? j : static_cast<long int>(checked_random() >> (1 + checked_random() % 63));
+		std::string tag    = tag_encode_checked(serial);
+		long int    decoded = -1, shape = -1;
+		if(tag.size() != tag_encoded_length_checked(serial) || tag_decode_checked(tag) != serial ||
+		   tag_try_decode_checked(tag, decoded) != tag_decode_status::ok || decoded != serial ||
+		   (serial < (1L << 56) && (tag_try_decode(tag, shape) != tag_decode_status::ok || shape / 34 != serial))){
+			std::cout << "Checked tag mismatch for " << serial << " (" << tag << ")" << std::endl;
+			checked_ok = false;
+			break;
+		}
+		if(j > 0 && j < 50000 && tag_compare(last_checked, tag) >= 0){
+			std::cout << "Checked tags out of order at " << serial << std::endl;
+			checked_ok = false;
+			break;
+		}
+		last_checked = tag;
+		if(j % 16 != 0){
+			continue;
+		}
+		for(std::size_t i = 0; i < tag.size(); i++){                         // every single-character substitution
+			for(const char* c = symbols; *c; c++){
+				std::string typo = tag;
+				typo[i] = *c;
+				if(typo != tag && tag_try_decode_checked(typo, decoded) == tag_decode_status::ok){
+					std::cout << "Substitution not caught: " << tag << " -> " << typo << std::endl;
+					checked_ok = false;
+				}
+			}
+		}
+		for(std::size_t i = 0; i + 1 < tag.size(); i++){                     // every adjacent transposition but '2' <-> 'z'
+			std::string typo = tag;
+			std::swap(typo[i], typo[i + 1]);
+			bool excused = (tag[i] == '2' && tag[i + 1] == 'z') || (tag[i] == 'z' && tag[i + 1] == '2');
+			if(typo != tag && !excused && tag_try_decode_checked(typo, decoded) == tag_decode_status::ok){
+				std::cout << "Transposition not caught: " << tag << " -> " << typo << std::endl;
+				checked_ok = false;
+			}
+		}
+	}
+	std::string checked_max = tag_encode_checked(std::numeric_limits<long int>::max());
+	long int    checked_serial = -1;
+	checked_ok = checked_ok && checked_max.size() == static_cast<std::size_t>(TAG_MAX_LENGTH_CHECKED) &&
+	             tag_decode_checked(checked_max) == std::numeric_limits<long int>::max() &&
+	             tag_try_decode_checked("", checked_serial) == tag_decode_status::blank &&
+	             tag_try_decode_checked("a", checked_serial) == tag_decode_status::bad_check &&
+	             tag_try_decode_checked("2" + tag_encode_checked(5), checked_serial) == tag_decode_status::non_canonical &&
+	             tag_try_decode_checked("b" + checked_max, checked_serial) != tag_decode_status::ok && checked_serial == -1;
+	std::string checked_upper = tag_encode_checked(2147483646L);
+	std::transform(checked_upper.begin(), checked_upper.end(), checked_upper.begin(), [](char c){ return static_cast<char>(std::toupper(c)); });
+	checked_ok = checked_ok && tag_decode_checked(checked_upper) == 2147483646L;
+	try{
+		std::string typo = tag_encode_checked(2147483646L);
+		typo.back() = typo.back() == 'z' ? 'y' : 'z';
+		tag_decode_checked(typo);
+		checked_ok = false;
+	}catch(std::invalid_argument& e){
+		checked_ok = checked_ok && std::string(e.what()).find("check character") != std::string::npos;
+	}
+	try{
+		tag_encode_checked(-1);
+		checked_ok = false;
+	}catch(std::out_of_range&){}
+	std::cout << (checked_ok ? "Check character test passed OK!" : "Check character test FAILED!") << std::endl;
+	ok = ok && checked_ok;
+
+	std::cout << "\n";
+	std::cout << "Testing the call counters (" << (TAG_ENCODE_STATS ? "compiled in" : "compiled out; build with -DTAG_ENCODE_STATS=1") << "): " << std::endl;
+	bool               stats_ok = true;
+	tag_stats_snapshot before   = tag_stats();
+	long int           stats_serial = 0;
+	for(long int j = 0; j < 1000; j++){
+		tag_try_decode(tag_encode(j * 7919), stats_serial);
+	}
+	tag_try_decode("", stats_serial);
+	tag_try_decode("2z", stats_serial);
+	tag_try_decode("6eh5g28yq5mi7bs", stats_serial);
+	tag_try_decode_padded("a22a22a2", stats_serial);
+	tag_try_decode_checked("fb", stats_serial);                             // the checked tag of 5 is "fa"
+	tag_stats_snapshot after = tag_stats();
+	if(TAG_ENCODE_STATS){
+		std::uint64_t sampled = 0, lengths = 0;
+		for(int b = 0; b < TAG_STATS_BUCKETS; b++){
+			sampled += (after.encode_ticks[b] - before.encode_ticks[b]) + (after.decode_ticks[b] - before.decode_ticks[b]);
+		}
+		for(int n = 0; n < TAG_STATS_LENGTHS; n++){
+			lengths += after.decode_lengths[n] - before.decode_lengths[n];
+		}
+		stats_ok = after.enabled && after.encodes - before.encodes == 1000 && after.decodes - before.decodes == 1005 &&
+		           after.decodes_by(tag_decode_status::ok) - before.decodes_by(tag_decode_status::ok) == 1001 &&
+		           after.failures() - before.failures() == 4 &&
+		           after.decodes_by(tag_decode_status::blank) - before.decodes_by(tag_decode_status::blank) == 1 &&
+		           after.decodes_by(tag_decode_status::bad_char) - before.decodes_by(tag_decode_status::bad_char) == 1 &&
+		           after.decodes_by(tag_decode_status::overflow) - before.decodes_by(tag_decode_status::overflow) == 1 &&
+		           after.decodes_by(tag_decode_status::bad_check) - before.decodes_by(tag_decode_status::bad_check) == 1 &&
+		           after.encode_lengths[1] - before.encode_lengths[1] == 1 && lengths == 1005 &&
+		           sampled >= 2 * 1000 / after.sample_interval;
+	}else{
+		stats_ok = !after.enabled && after.encodes == 0 && after.decodes == 0 && after.failures() == 0;
+	}
+	std::cout << (stats_ok ? "Counters test passed OK!" : "Counters test FAILED!") << std::endl;
+	ok = ok && stats_ok;
+	
+	std::cout << "\n";
+	std::cout << "Testing that tag_range_cover() and tag_range_prefixes() cover exactly the serial range: " << std::endl;
+	bool                     range_ok = true;
+	const std::size_t        range_width = 4;
+	std::vector<std::string> range_tags;                                                // every padded tag of the width, in serial order
+	for(long int j = 0; j < 34L * 26 * 8 * 34; j++){
+		range_tags.push_back(tag_encode_padded(j, range_width));
+	}
+	auto key_rank = [&](const std::string& key){                                         // serials whose tags sort below `key`
+		return static_cast<long int>(std::lower_bound(range_tags.begin(), range_tags.end(), key) - range_tags.begin());
+	};
+	std::mt19937_64 range_random(20130106);
+	for(int j = 0; j < 20000 && range_ok; j++){
+		long int lo = range_random() % range_tags.size(), hi = range_random() % range_tags.size();
+		if(j % 4 == 0){
+			hi = std::min<long int>(lo + range_random() % 300, range_tags.size() - 1);
+		}
+		if(hi < lo){
+			std::swap(lo, hi);
+		}
+		long int                      next  = lo;                                       // each piece must start where the last one stopped
+		std::vector<tag_prefix_range> cover = tag_range_cover(lo, hi, range_width);
+		for(const tag_prefix_range& range : cover){
+			long int from = key_rank(range.prefix + range.first), to = key_rank(range.prefix + static_cast<char>(range.last + 1));
+			range_ok = range_ok && from == next && to > from && range.prefix.size() < range_width;
+			next     = to;
+		}
+		next = lo;
+		for(const std::string& prefix : tag_range_prefixes(lo, hi, range_width)){
+			long int from = key_rank(prefix), to = key_rank(prefix + '\x7f');
+			range_ok = range_ok && from == next && to > from;
+			next     = to;
+		}
+		range_ok = range_ok && next == hi + 1 && cover.size() <= 2 * range_width;
+		if(!range_ok){
+			std::cout << "Range cover mismatch on [" << lo << ", " << hi << "]" << std::endl;
+		}
+	}
+	range_ok = range_ok && tag_range_cover(0, range_tags.size() - 1, range_width).size() == 1 &&
+	           tag_range_cover(0, std::numeric_limits<long int>::max()).size() <= 2 * TAG_MAX_LENGTH &&
+	           tag_range_prefixes(340, 679, range_width) == std::vector<std::string>{"22k", "22l", "22m", "22n", "22o", "22p", "22q", "22r", "22s", "22t"} &&
+	           tag_range_cover(5, 4).empty();
+	try{
+		tag_range_cover(-1, 4);
+		range_ok = false;
+	}catch(std::out_of_range&){}
+	try{
+		tag_range_cover(0, range_tags.size(), range_width);
+		range_ok = false;
+	}catch(std::length_error&){}
+	std::cout << (range_ok ? "Range cover test passed OK!" : "Range cover test FAILED!") << std::endl;
+	ok = ok && range_ok;
+	
+	std::cout << "\n";
+	std::cout << "Testing tag_codec: the default instantiation matches tag_encode(), variants round-trip: " << std::endl;
+	bool codec_ok = tag_default_codec::max_length == TAG_MAX_LENGTH;
+	for(long int j = 0, step = 1; codec_ok && j < std::numeric_limits<long int>::max() - step; j += step, step += step / 8 + 1){
+		codec_ok = tag_default_codec::encode(j) == tag_encode(j) && tag_default_codec::encoded_length(j) == tag_encoded_length(j) &&
+		           tag_default_codec::encode(std::numeric_limits<long int>::max()) == tag_encode(std::numeric_limits<long int>::max());
+	}
+	std::mt19937_64 codec_random(20130107);
+	const char      codec_chars[] = "2389abhkoxyzABZ01-_";
+	for(int j = 0; j < 200000 && codec_ok; j++){
+		std::string text(codec_random() % 18, ' ');
+		for(char& c : text){
+			c = codec_chars[codec_random() % (sizeof(codec_chars) - 1)];
+		}
+		long int by_codec = -1, by_tag = -1;
+		codec_ok = tag_default_codec::try_decode(text, by_codec) == tag_try_decode(text, by_tag) && by_codec == by_tag;
+		if(!codec_ok){
+			std::cout << "Codec mismatch on \"" << text << "\"" << std::endl;
+		}
+	}
+	using label_codec  = tag_codec<label_alphabet, tag_radix<0, 32>, tag_radix<8, 24>, tag_radix<0, 8>>;
+	using keypad_codec = tag_codec<keypad_alphabet, tag_radix<0, 10>>;
+	for(long int j = 0, step = 1; codec_ok && j < std::numeric_limits<long int>::max() - step; j += step, step += step / 8 + 1){
+		long int    serial = -1;
+		std::string label  = label_codec::encode(j);
+		codec_ok = label_codec::try_decode(label, serial) == tag_decode_status::ok && serial == j &&
+		           label.size() == label_codec::encoded_length(j) && keypad_codec::encode(j) == std::to_string(j) &&
+		           keypad_codec::decode(std::to_string(j)) == j;
+		for(std::size_t i = 0; i + 1 < label.size(); i++){
+			codec_ok = codec_ok && !(std::isdigit(label[i]) && std::isdigit(label[i + 1]) && i + 2 < label.size() && std::isdigit(label[i + 2]));
+		}
+	}
+	long int codec_serial = 0;
+	codec_ok = codec_ok && label_codec::encode(2147483646) == "BS9CP4RY" && label_codec::decode("bs9cp4ry") == 2147483646 &&
+	           label_codec::try_decode("BS9CO4RY", codec_serial) == tag_decode_status::bad_char &&
+	           keypad_codec::decode("1o") == 10 && keypad_codec::max_length == 19 &&
+	           keypad_codec::try_decode("9223372036854775808", codec_serial) == tag_decode_status::overflow &&
+	           keypad_codec::try_decode("07", codec_serial) == tag_decode_status::non_canonical;
+	try{
+		keypad_codec::decode("");
+		codec_ok = false;
+	}catch(std::invalid_argument&){}
+	std::cout << (codec_ok ? "Codec test passed OK!" : "Codec test FAILED!") << std::endl;
+	ok = ok && codec_ok;
+	
+	std::cout << "\n";
+	std::cout << "Testing that tag_is_plausible() checks exactly the length and the character classes: " << std::endl;
+	bool            plausible_ok = !tag_is_plausible("") && !tag_is_plausible("6eh5g28yq5mi7br2") && tag_is_plausible("6EH5G28YQ5MI7BR");
+	std::mt19937_64 plausible_random(20130108);
+	const char      plausible_chars[] = "2389abhkoxyzABZ01@[`{/:";
+	for(int j = 0; j < 1000000 && plausible_ok; j++){
+		std::string text(plausible_random() % 18, ' ');
+		for(char& c : text){
+			c = plausible_random() % 64 == 0 ? static_cast<char>(plausible_random()) : plausible_chars[plausible_random() % (sizeof(plausible_chars) - 1)];
+		}
+		bool expected = !text.empty() && text.size() <= static_cast<std::size_t>(TAG_MAX_LENGTH);
+		for(std::size_t i = 0; i < text.size(); i++){
+			expected = expected && tag_encode_detail::DIGITS.value[(text.size() - 1 - i) % 3][static_cast<unsigned char>(text[i])] != tag_encode_detail::INVALID_DIGIT;
+		}
+		plausible_ok = tag_is_plausible(text) == expected && (tag_is_plausible(text) || !tag_try_decode(text).has_value());
+		if(!plausible_ok){
+			std::cout << "Plausibility mismatch on \"" << text << "\"" << std::endl;
+		}
+	}
+	for(long int j = 0, step = 1; plausible_ok && j < std::numeric_limits<long int>::max() - step; j += step, step += step / 16 + 1){
+		plausible_ok = tag_is_plausible(tag_encode(j)) && tag_is_plausible(tag_encode(j + 1));
+	}
+	std::cout << (plausible_ok ? "Plausibility test passed OK!" : "Plausibility test FAILED!") << std::endl;
+	ok = ok && plausible_ok;
+	
+	std::cout << "\n";
+	std::cout << "Testing that tag_value holds canonical tags and hashes to their serial numbers: " << std::endl;
+	bool                                    value_ok = tag_value().empty() && std::hash<tag_value>()(tag_value()) == SIZE_MAX && !tag_value::try_parse("ba9n82d!") &&
+	                                                   tag_value(std::numeric_limits<long int>::max()).view() == "6eh5g28yq5mi7br";
+	std::mt19937_64                         value_random(20130109);
+	std::unordered_map<tag_value, long int> value_map;
+	tag_value                               previous_value;
+	long int                                previous_serial = -1;
+	for(int j = 0; j < 1000000 && value_ok; j++){
+		long int    serial = static_cast<long int>(value_random() >> (1 + value_random() % 63));
+		tag_value   value(serial);
+		std::string typed = tag_encode(serial);
+		for(char& c : typed){
+			c = value_random() % 2 ? static_cast<char>(std::toupper(c)) : (c == 'o' ? '0' : c == 'l' ? '1' : c);
+		}
+		value_ok = value.view() == tag_encode(serial) && value.serial() == serial && std::hash<tag_value>()(value) == static_cast<std::size_t>(serial) &&
+		           tag_value(typed) == value && tag_value::try_parse(typed) == value &&
+		           (previous_value < value) == (previous_serial < serial) && (previous_value == value) == (previous_serial == serial);
+		if(!value_ok){
+			std::cout << "tag_value mismatch on " << serial << " (typed as \"" << typed << "\")" << std::endl;
+		}
+		if(j < 100000){
+			value_map[value] = serial;
+		}
+		previous_value  = value;
+		previous_serial = serial;
+	}
+	for(const auto& entry : value_map){
+		value_ok = value_ok && entry.first.serial() == entry.second && value_map.at(tag_value(entry.second)) == entry.second;
+	}
+	try{
+		tag_value("ba9n82d!");
+		value_ok = false;
+	}catch(std::invalid_argument&){}
+	std::cout << (value_ok ? "Tag value test passed OK!" : "Tag value test FAILED!") << std::endl;
+	ok = ok && value_ok;
 	
-	return 0;
+	return ok ? 0 : 1;
 }
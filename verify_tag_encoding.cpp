@@ -0,0 +1,474 @@
+/**
+ * @file verify_tag_encoding.cpp
+ *
+ * Exhaustive verifier for "tag_encode.h".  Every serial number in
+ * [0, 2^bits) (2^32 by default) is encoded and decoded by every code path:
+ * the reference per-character loop, the group-table encoder, every batch
+ * encoder and decoder kernel the CPU supports, `tag_try_decode()` and the
+ * padded forms.  Each must agree with reference tags produced by
+ * `tag_counter`, which steps from tag to tag without division.  The range is
+ * cut into shards shared by all threads; finished shards are appended to a
+ * checkpoint file so that an interrupted run resumes where it stopped.
+ *
+ * The rest of the 64-bit range is covered by stratified random samples of
+ * every tag length, alternating with blocks that mix all lengths (checked
+ * against the reference loop), and by sweeps
+ * around every tag-length threshold, every power of two and the largest
+ * 'long int'.  Tags computed at compile time with `tag_constant` are
+ * compared at the thresholds as well.
+ *
+ *     verify_tag_encoding [-j threads] [-c checkpoint] [-b bits] [-n samples] [-w width] [-s seed]
+ *
+ * Build (POSIX):
+ *     g++ -std=c++17 -O2 -march=native -pthread -o verify_tag_encoding verify_tag_encoding.cpp
+ *
+ *
+ * @copyright (c) 2013 Jason L Causey,
+ * Distributed under the MIT License (MIT):
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<string>
+#include<vector>
+#include<set>
+#include<random>
+#include<thread>
+#include<mutex>
+#include<atomic>
+#include<chrono>
+#include<utility>
+#include<algorithm>
+
+#include<unistd.h>
+
+#include "tag_encode.h"
+
+namespace{
+    constexpr std::size_t BLOCK      = 4096;                                        // serials checked per batch call
+    constexpr int         SHARD_BITS = 24;                                          // serials per checkpointed shard: 2^24
+
+    /**
+     * @brief  failure counter shared by all threads; the first few failures are printed
+     */
+    class failure_log{
+    public:
+        void report(long int serial, const char* path, const std::string& got, const char* expected, std::size_t length){
+            std::lock_guard<std::mutex> guard(lock);
+            if(count++ < 20){
+                std::fprintf(stderr, "MISMATCH at serial %ld: %s gave \"%s\", expected \"%.*s\"\n",
+                             serial, path, got.c_str(), static_cast<int>(length), expected);
+            }
+        }
+
+        unsigned long failures() const{
+            return count;
+        }
+
+    private:
+        std::mutex              lock;
+        std::atomic<unsigned long> count{0};
+    };
+
+    /**
+     * @brief  every batch kernel compiled in, with the instruction set it needs
+     */
+    struct{
+        const char*                     name;
+        void                          (*kernel)(const std::int64_t*, std::size_t, char*, std::uint8_t*) noexcept;
+        tag_encode_detail::cpu_level    level;
+    } const ENCODERS[] = {
+        {"tag_encode_batch",    tag_encode_batch,                       tag_encode_detail::cpu_level::scalar},
+        {"encode_batch_scalar", tag_encode_detail::encode_batch_scalar, tag_encode_detail::cpu_level::scalar},
+#if TAG_ENCODE_AVX2
+        {"encode_batch_avx2",   tag_encode_detail::encode_batch_avx2,   tag_encode_detail::cpu_level::avx2},
+#endif
+#if TAG_ENCODE_AVX512
+        {"encode_batch_avx512", tag_encode_detail::encode_batch_avx512, tag_encode_detail::cpu_level::avx512},
+#endif
+    };
+
+    struct{
+        const char*                     slots_name;
+        void                          (*slots)(const char*, std::size_t, std::int64_t*, std::uint8_t*) noexcept;
+        const char*                     offsets_name;
+        void                          (*offsets)(const char*, const std::int32_t*, std::size_t, std::int64_t*, std::uint8_t*) noexcept;
+        tag_encode_detail::cpu_level    level;
+    } const DECODERS[] = {
+        {"tag_decode_batch",    tag_decode_batch,
+         "tag_decode_batch (offsets)", tag_decode_batch,                             tag_encode_detail::cpu_level::scalar},
+        {"decode_batch_scalar", tag_encode_detail::decode_batch_scalar,
+         "decode_offsets_scalar",      tag_encode_detail::decode_offsets_scalar,     tag_encode_detail::cpu_level::scalar},
+#if TAG_ENCODE_SSSE3
+        {"decode_batch_ssse3",  tag_encode_detail::decode_batch_ssse3,
+         "decode_offsets_ssse3",       tag_encode_detail::decode_offsets_ssse3,      tag_encode_detail::cpu_level::ssse3},
+#endif
+    };
+
+    /**
+     * @brief  reusable buffers for checking one block of serial numbers
+     */
+    struct block_check{
+        std::vector<std::int64_t>   serials  = std::vector<std::int64_t>(BLOCK);
+        std::vector<char>           expected = std::vector<char>(BLOCK * TAG_BATCH_STRIDE);     // reference tags, NUL-padded slots
+        std::vector<std::uint8_t>   lengths  = std::vector<std::uint8_t>(BLOCK);
+        std::vector<char>           encoded  = std::vector<char>(BLOCK * TAG_BATCH_STRIDE);
+        std::vector<std::uint8_t>   encoded_lengths = std::vector<std::uint8_t>(BLOCK);
+        std::vector<std::int64_t>   decoded  = std::vector<std::int64_t>(BLOCK);
+        std::vector<std::uint8_t>   valid    = std::vector<std::uint8_t>(BLOCK / 8);
+        std::vector<char>           packed   = std::vector<char>(BLOCK * TAG_MAX_LENGTH);
+        std::vector<std::int32_t>   offsets  = std::vector<std::int32_t>(BLOCK + 1);
+
+        void set_expected(std::size_t i, long int serial, std::string_view tag){
+            serials[i] = serial;
+            lengths[i] = tag.size();
+            std::memset(&expected[i * TAG_BATCH_STRIDE], 0, TAG_BATCH_STRIDE);
+            std::memcpy(&expected[i * TAG_BATCH_STRIDE], tag.data(), tag.size());
+        }
+
+        /**
+         * @brief  check the first `n` serials against their expected tags on every path
+         */
+        void check(std::size_t n, failure_log& log){
+            for(std::size_t i = 0; i < n; i++){
+                long int    serial = serials[i];
+                const char* tag    = &expected[i * TAG_BATCH_STRIDE];
+                std::size_t length = lengths[i];
+                char        buffer[TAG_MAX_LENGTH];
+                tag_encode_detail::encode_digits(serial, buffer + TAG_MAX_LENGTH);
+                if(std::memcmp(buffer + TAG_MAX_LENGTH - length, tag, length) != 0 || tag_encoded_length(serial) != length){
+                    log.report(serial, "reference loop", std::string(buffer + TAG_MAX_LENGTH - length, length), tag, length);
+                }
+                if(tag_encode(serial, buffer, TAG_MAX_LENGTH) != length ||
+                   std::memcmp(buffer + TAG_MAX_LENGTH - length, tag, length) != 0){
+                    log.report(serial, "tag_encode", std::string(buffer + TAG_MAX_LENGTH - length, length), tag, length);
+                }
+                long int back = -1;
+                if(tag_try_decode(std::string_view(tag, length), back) != tag_decode_status::ok || back != serial){
+                    log.report(serial, "tag_try_decode", std::to_string(back), tag, length);
+                }
+                tag_encode_padded(serial, buffer, TAG_MAX_LENGTH);
+                if(std::memcmp(buffer + TAG_MAX_LENGTH - length, tag, length) != 0 ||
+                   tag_try_decode_padded(std::string_view(buffer, TAG_MAX_LENGTH), back) != tag_decode_status::ok || back != serial){
+                    log.report(serial, "padded", std::string(buffer, TAG_MAX_LENGTH), tag, length);
+                }
+            }
+            for(const auto& encoder : ENCODERS){
+                if(tag_encode_detail::cpu() < encoder.level){
+                    continue;                                                       // kernel not supported by this CPU
+                }
+                encoder.kernel(serials.data(), n, encoded.data(), encoded_lengths.data());
+                for(std::size_t i = 0; i < n; i++){
+                    if(encoded_lengths[i] != lengths[i] ||
+                       std::memcmp(&encoded[i * TAG_BATCH_STRIDE], &expected[i * TAG_BATCH_STRIDE], TAG_BATCH_STRIDE) != 0){
+                        log.report(serials[i], encoder.name, std::string(&encoded[i * TAG_BATCH_STRIDE], encoded_lengths[i]),
+                                   &expected[i * TAG_BATCH_STRIDE], lengths[i]);
+                    }
+                }
+            }
+            offsets[0] = 0;
+            for(std::size_t i = 0; i < n; i++){                                     // the same tags packed end to end
+                offsets[i + 1] = offsets[i] + lengths[i];
+                std::memcpy(&packed[offsets[i]], &expected[i * TAG_BATCH_STRIDE], lengths[i]);
+            }
+            for(const auto& decoder : DECODERS){
+                if(tag_encode_detail::cpu() < decoder.level){
+                    continue;
+                }
+                decoder.slots(expected.data(), n, decoded.data(), valid.data());
+                check_decoded(n, decoder.slots_name, log);
+                decoder.offsets(packed.data(), offsets.data(), n, decoded.data(), valid.data());
+                check_decoded(n, decoder.offsets_name, log);
+            }
+        }
+
+        void check_decoded(std::size_t n, const char* path, failure_log& log){
+            for(std::size_t i = 0; i < n; i++){
+                if(decoded[i] != serials[i] || !(valid[i / 8] & (1u << (i % 8)))){
+                    log.report(serials[i], path, std::to_string(decoded[i]), &expected[i * TAG_BATCH_STRIDE], lengths[i]);
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief  check `count` consecutive serials from `first`, using `tag_counter` for the reference tags
+     */
+    void check_range(long int first, unsigned long count, block_check& block, failure_log& log){
+        tag_counter counter(first);
+        for(unsigned long done = 0; done < count; ){
+            std::size_t n = std::min<unsigned long>(BLOCK, count - done);
+            for(std::size_t i = 0; i < n; i++){
+                block.set_expected(i, counter.serial(), counter.tag());
+                if(done + i + 1 < count){
+                    ++counter;
+                }
+            }
+            block.check(n, log);
+            done += n;
+        }
+    }
+
+    /**
+     * @brief  list of finished shards, kept in an append-only text file
+     */
+    class checkpoint{
+    public:
+        checkpoint(const char* path, int bits) : header("tag_encode verify bits=" + std::to_string(bits)){
+            if(!path){
+                return;
+            }
+            if(FILE* in = std::fopen(path, "r")){
+                char line[128];
+                if(std::fgets(line, sizeof(line), in) && std::string(line) != header + "\n"){
+                    std::fprintf(stderr, "verify_tag_encoding: %s was written for a different run\n", path);
+                    std::exit(2);
+                }
+                while(std::fgets(line, sizeof(line), in)){
+                    if(std::strncmp(line, "shard ", 6) == 0){
+                        done.insert(std::strtoul(line + 6, nullptr, 10));
+                    }else if(std::strncmp(line, "sampled", 7) == 0){
+                        sampled = std::string(line);
+                    }
+                }
+                std::fclose(in);
+            }
+            bool fresh = done.empty() && sampled.empty();
+            file = std::fopen(path, "a");
+            if(!file){
+                std::perror(path);
+                std::exit(2);
+            }
+            if(fresh){
+                std::fprintf(file, "%s\n", header.c_str());
+                std::fflush(file);
+            }
+        }
+
+        ~checkpoint(){
+            if(file){
+                std::fclose(file);
+            }
+        }
+
+        bool finished(unsigned long shard) const{
+            return done.count(shard) > 0;
+        }
+
+        std::size_t finished_count() const{
+            return done.size();
+        }
+
+        void record(unsigned long shard){
+            std::lock_guard<std::mutex> guard(lock);
+            if(file){
+                std::fprintf(file, "shard %lu\n", shard);
+                std::fflush(file);
+                fsync(fileno(file));
+            }
+        }
+
+        /**
+         * @brief  true if the 64-bit phase already passed with these settings
+         */
+        bool sampled_with(const std::string& settings) const{
+            return sampled == settings + "\n";
+        }
+
+        void record_sampled(const std::string& settings){
+            if(file){
+                std::fprintf(file, "%s\n", settings.c_str());
+                std::fflush(file);
+            }
+        }
+
+    private:
+        std::string             header;
+        std::set<unsigned long> done;
+        std::string             sampled;
+        FILE*                   file = nullptr;
+        std::mutex              lock;
+    };
+
+    /**
+     * @brief  run `task(0)` ... `task(count - 1)` on `threads` threads
+     */
+    template<typename Task>
+    void parallel_for(unsigned threads, unsigned long count, Task task){
+        std::atomic<unsigned long> next{0};
+        std::vector<std::thread>   workers;
+        for(unsigned t = 0; t < threads; t++){
+            workers.emplace_back([&]{
+                block_check block;
+                for(unsigned long i = next++; i < count; i = next++){
+                    task(i, block);
+                }
+            });
+        }
+        for(std::thread& worker : workers){
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief  compare `tag_constant` (compile-time tags) with the reference loop next to each length threshold
+     */
+    template<std::size_t... I>
+    bool check_constants(std::index_sequence<I...>){
+        constexpr long int MAX = std::numeric_limits<long int>::max();
+        const std::pair<long int, std::string_view> constants[] = {
+            {static_cast<long int>(tag_encode_detail::LENGTHS.limit[I]) - 1, tag_constant<static_cast<long int>(tag_encode_detail::LENGTHS.limit[I]) - 1>}...,
+            {static_cast<long int>(tag_encode_detail::LENGTHS.limit[I]),     tag_constant<static_cast<long int>(tag_encode_detail::LENGTHS.limit[I])>}...,
+            {0, tag_constant<0>}, {MAX, tag_constant<MAX>}
+        };
+        bool ok = true;
+        for(const auto& constant : constants){
+            char        buffer[TAG_MAX_LENGTH];
+            std::size_t length = tag_encoded_length(constant.first);
+            tag_encode_detail::encode_digits(constant.first, buffer + TAG_MAX_LENGTH);
+            if(std::string_view(buffer + TAG_MAX_LENGTH - length, length) != constant.second){
+                std::fprintf(stderr, "MISMATCH at serial %ld: tag_constant gave \"%.*s\"\n",
+                             constant.first, static_cast<int>(constant.second.size()), constant.second.data());
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    void usage(){
+        std::fprintf(stderr,
+            "usage: verify_tag_encoding [-j threads] [-c checkpoint] [-b bits] [-n samples] [-w width] [-s seed]\n"
+            "  -j threads     worker threads (default: all cores)\n"
+            "  -c checkpoint  record finished shards here and skip them when resuming\n"
+            "  -b bits        verify every serial below 2^bits exhaustively (default 32)\n"
+            "  -n samples     random samples per tag length above that range (default 1000000)\n"
+            "  -w width       serials checked on each side of every boundary (default 65536)\n"
+            "  -s seed        random seed for the samples (default 1)\n");
+    }
+}
+
+int main(int argc, char* argv[]){
+    unsigned      threads    = std::max(1u, std::thread::hardware_concurrency());
+    const char*   checkpoint_path = nullptr;
+    int           bits       = 32;
+    unsigned long samples    = 1000000;
+    unsigned long width      = 65536;
+    unsigned long seed       = 1;
+    int           opt;
+    while((opt = getopt(argc, argv, "j:c:b:n:w:s:")) != -1){
+        switch(opt){
+            case 'j': threads         = std::max(1ul, std::strtoul(optarg, nullptr, 10)); break;
+            case 'c': checkpoint_path = optarg;                                          break;
+            case 'b': bits            = std::atoi(optarg);                               break;
+            case 'n': samples         = std::strtoul(optarg, nullptr, 10);               break;
+            case 'w': width           = std::strtoul(optarg, nullptr, 10);               break;
+            case 's': seed            = std::strtoul(optarg, nullptr, 10);               break;
+            default:  usage();                                                           return 2;
+        }
+    }
+    if(bits < 1 || bits > 62 || width < 1){
+        usage();
+        return 2;
+    }
+
+    auto        start = std::chrono::steady_clock::now();
+    failure_log log;
+    checkpoint  progress(checkpoint_path, bits);
+
+    bool constants_ok = check_constants(std::make_index_sequence<TAG_MAX_LENGTH - 1>());
+    std::fprintf(stderr, "compile-time tags: %s\n", constants_ok ? "OK" : "FAILED");
+
+    int           shard_bits = std::min(bits, SHARD_BITS);
+    unsigned long shards     = 1ul << (bits - shard_bits);
+    std::atomic<unsigned long> finished{progress.finished_count()};
+    std::fprintf(stderr, "exhaustive: %lu shards of 2^%d serials, %zu already done\n", shards, shard_bits, progress.finished_count());
+    parallel_for(threads, shards, [&](unsigned long shard, block_check& block){
+        if(progress.finished(shard)){
+            return;
+        }
+        unsigned long failures = log.failures();
+        check_range(static_cast<long int>(shard << shard_bits), 1ul << shard_bits, block, log);
+        if(log.failures() == failures){
+            progress.record(shard);                                                 // only clean shards are skipped on resume
+        }
+        unsigned long now = ++finished;
+        if(now % 16 == 0 || now == shards){
+            std::fprintf(stderr, "  %lu/%lu shards (%.1f%%)\n", now, shards, 100.0 * now / shards);
+        }
+    });
+
+    std::string sampled = "sampled bits=" + std::to_string(bits) + " n=" + std::to_string(samples) +
+                          " w=" + std::to_string(width) + " seed=" + std::to_string(seed);
+    if(progress.sampled_with(sampled)){
+        std::fprintf(stderr, "sampled 64-bit range: already done\n");
+    }else{
+        std::vector<std::pair<long int, unsigned long>> sweeps;                    // (first serial, count)
+        constexpr long int MAX = std::numeric_limits<long int>::max();
+        auto sweep_around = [&](unsigned long boundary){
+            unsigned long first = boundary > width ? boundary - width : 0;
+            unsigned long last  = std::min<unsigned long>(boundary + width, MAX);
+            sweeps.emplace_back(first, last - first + 1);
+        };
+        for(int length = 1; length < TAG_MAX_LENGTH; length++){
+            sweep_around(tag_encode_detail::LENGTHS.limit[length - 1]);
+        }
+        for(int power = 1; power < std::numeric_limits<long int>::digits; power++){
+            sweep_around(1ul << power);
+        }
+        sweep_around(MAX);
+        parallel_for(threads, sweeps.size(), [&](unsigned long s, block_check& block){
+            check_range(sweeps[s].first, sweeps[s].second, block, log);
+        });
+        std::fprintf(stderr, "boundary sweeps: %zu ranges of up to %lu serials\n", sweeps.size(), 2 * width + 1);
+
+        parallel_for(threads, TAG_MAX_LENGTH, [&](unsigned long stratum, block_check& block){
+            std::vector<std::uniform_int_distribution<long int>> strata;            // serials of each tag length
+            for(int length = 1; length <= TAG_MAX_LENGTH; length++){
+                strata.emplace_back((length == 1) ? 0 : tag_encode_detail::LENGTHS.limit[length - 2],
+                                    (length == TAG_MAX_LENGTH) ? MAX : tag_encode_detail::LENGTHS.limit[length - 1] - 1);
+            }
+            std::mt19937_64                 rng(seed * TAG_MAX_LENGTH + stratum);
+            std::uniform_int_distribution<> any_stratum(0, TAG_MAX_LENGTH - 1);
+            for(unsigned long done = 0, blocks = 0; done < samples; blocks++){
+                std::size_t n = std::min<unsigned long>(BLOCK, samples - done);
+                for(std::size_t i = 0; i < n; i++){                                 // odd blocks mix every length, so that
+                    long int serial = strata[blocks % 2 ? any_stratum(rng) : stratum](rng);   // SIMD lanes differ in length
+                    char     buffer[TAG_MAX_LENGTH];
+                    std::size_t length = tag_encoded_length(serial);
+                    tag_encode_detail::encode_digits(serial, buffer + TAG_MAX_LENGTH);  // reference tags for samples
+                    block.set_expected(i, serial, std::string_view(buffer + TAG_MAX_LENGTH - length, length));
+                }
+                block.check(n, log);
+                done += n;
+            }
+        });
+        std::fprintf(stderr, "stratified samples: %lu per tag length\n", samples);
+        if(log.failures() == 0){
+            progress.record_sampled(sampled);
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bool   ok      = constants_ok && log.failures() == 0;
+    std::printf("%s: %lu mismatches, %.1f s\n", ok ? "VERIFIED" : "FAILED", log.failures(), seconds);
+    return ok ? 0 : 1;
+}